@@ -0,0 +1,86 @@
+/**
+ * @file io_aligned_pool.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 15:08:20
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef IO_ALIGNED_POOL_HPP_
+#define IO_ALIGNED_POOL_HPP_
+
+#include <mutex>
+#include <vector>
+
+#include "defines.hpp"
+
+namespace io {
+
+/**
+ * @brief
+ *
+ * 뻺ء
+ *
+ * еĻС̶ʼַalignment룬O_DIRECTҪ
+ * 黹иãֻڳضʱͷš
+ * ͹黹̰߳ȫġ
+ */
+class AlignedBufferPool {
+ public:
+  static constexpr size_t DEFAULT_ALIGNMENT = 4096u;
+
+ public:
+  explicit AlignedBufferPool(size_t buffer_size,
+                             size_t alignment = DEFAULT_ALIGNMENT);
+
+  ~AlignedBufferPool();
+
+  AlignedBufferPool(const AlignedBufferPool&) = delete;
+
+  // һؿʱ·һ
+  char* acquire();
+
+  // 黹һacquire()Ļ
+  void release(char* buffer);
+
+  size_t buffer_size() const;
+
+  size_t alignment() const;
+
+ public:
+  /**
+   * @brief
+   *
+   * ӳнĻʱԶ黹
+   */
+  class Buffer {
+   public:
+    explicit Buffer(AlignedBufferPool& pool);
+
+    ~Buffer();
+
+    Buffer(const Buffer&) = delete;
+
+    char* data();
+
+    size_t size() const;
+
+   protected:
+    AlignedBufferPool& pool_;
+    char* data_;
+  };
+
+ protected:
+  size_t buffer_size_;
+  size_t alignment_;
+  std::mutex lock_;
+  std::vector<char*> free_;
+  std::vector<char*> all_;
+};
+
+}  // namespace io
+
+#endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+/**
+ * @file io_direct_file.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 15:30:12
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef IO_DIRECT_FILE_HPP_
+#define IO_DIRECT_FILE_HPP_
+
+#include <mutex>
+
+#include "io_aligned_pool.hpp"
+#include "io_posix_file.hpp"
+
+namespace io {
+
+/**
+ * @brief
+ *
+ * O_DIRECT򿪵Ĵļʽдƹҳ档
+ *
+ * ƫơȺͻַҪֱӽںˣ
+ * ɶ뻺תĶ뵥Ԫȶд
+ * Ҫڴʱں˲ѯѯʱ4096ֽڴ
+ */
+class DirectFile : public PosixFile {
+ public:
+  explicit DirectFile(const std::string& filepath);
+
+  virtual bool read_at(i64 offset, char* dest_addr, size_t rdsize) override;
+
+  virtual bool write_at(i64 offset, const char* src_addr,
+                        size_t wrsize) override;
+
+  virtual bool readv_at(i64 offset, const IoSlice* slices,
+                        size_t cnt) override;
+
+  virtual bool writev_at(i64 offset, const IoSlice* slices,
+                         size_t cnt) override;
+
+  // ɱฺ𣬲ⲿ档
+  virtual int native_handle() override;
+
+  virtual size_t alignment() override;
+
+ protected:
+  bool is_aligned(i64 offset, const char* addr, size_t size) const;
+
+ protected:
+  // ƫƺͳȵĶ뵥λ
+  size_t offset_align_ = AlignedBufferPool::DEFAULT_ALIGNMENT;
+  // ַĶ뵥λ
+  size_t memory_align_ = AlignedBufferPool::DEFAULT_ALIGNMENT;
+  // ת
+  AlignedBufferPool bounce_pool_;
+  // ȶдĹҪ⣬าǡ
+  std::mutex rmw_lock_;
+};
+
+}  // namespace io
+
+#endif
\ No newline at end of file
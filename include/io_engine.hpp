@@ -0,0 +1,105 @@
+/**
+ * @file io_engine.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 13:05:42
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef IO_ENGINE_HPP_
+#define IO_ENGINE_HPP_
+
+#include <vector>
+
+#include "io_file.hpp"
+
+namespace io {
+
+/**
+ * @brief
+ *
+ * д档
+ *
+ * Ŷɶλдٵsubmit()һύȴȫɡ
+ * ŶӵĻsubmit()discard()ǰ뱣Ч
+ * 汾̰߳ȫġ
+ */
+class IoEngine {
+ public:
+  explicit IoEngine(FileBase& file);
+
+  virtual ~IoEngine();
+
+  void queue_read(i64 offset, char* dest_addr, size_t rdsize);
+
+  void queue_write(i64 offset, const char* src_addr, size_t wrsize);
+
+  // Ŷһɢ/ۼ󣬸ڴζӦļϵ
+  void queue_readv(i64 offset, const IoSlice* slices, size_t cnt);
+
+  void queue_writev(i64 offset, const IoSlice* slices, size_t cnt);
+
+  // ǰŶӵ
+  size_t queued() const;
+
+  // Ŷӵ
+  void discard();
+
+  // ύŶӵ󲢵ȴɣȫɹʱtrue
+  virtual bool submit() = 0;
+
+  // ƣ־͵ԡ
+  virtual const char* name() const = 0;
+
+  /**
+   * @brief
+   *
+   * ʺϸļ棺ļṩԭƽ̨֧io_uringʱ
+   * ʹio_uring˻Ϊλдͬ档
+   * depth=0ʱʹͬ档
+   */
+  static IoEngine* create(FileBase& file, u32 depth);
+
+ protected:
+  // ӵfirstִŶӵȻնС
+  bool submit_each(size_t first = 0);
+
+ protected:
+  struct Request {
+    i64 offset_;
+    // slices_еʼ±Ͷ
+    size_t slice_begin_;
+    size_t slice_cnt_;
+    // ֽ
+    size_t size_;
+    bool write_;
+  };
+
+  void queue(i64 offset, const IoSlice* slices, size_t cnt, bool write);
+
+ protected:
+  FileBase& file_;
+  std::vector<Request> requests_;
+  std::vector<IoSlice> slices_;
+};
+
+/**
+ * @brief
+ *
+ * ͬ棺Ŷ˳FileBaseĶλд
+ */
+class SyncIoEngine : public IoEngine {
+ public:
+  explicit SyncIoEngine(FileBase& file);
+
+  virtual bool submit() override;
+
+  virtual const char* name() const override;
+};
+
+}  // namespace io
+
+#endif
\ No newline at end of file
@@ -12,12 +12,24 @@
 #ifndef IO_FILE_HPP_
 #define IO_FILE_HPP_
 
+#include <atomic>
+#include <mutex>
 #include <string>
 
 #include "defines.hpp"
 
 namespace io {
 
+/**
+ * @brief
+ *
+ * ɢ/ۼдеһڴ档
+ */
+struct IoSlice {
+  char* addr_;
+  size_t size_;
+};
+
 /**
  * @brief
  *
@@ -52,10 +64,52 @@ class FileBase {
 
   virtual std::string error() = 0;
 
+  /**
+   * @brief
+   *
+   * λдָƫƴдʹҲıдαꡣ
+   * ֻдָȲŷtrueʧʱ¼Ϣ
+   *
+   * Ĭʵּͨseek+read/writeɣֶ֧λд
+   * ӦǣʹͬƫϵĲд
+   */
+  virtual bool read_at(i64 offset, char* dest_addr, size_t rdsize);
+
+  virtual bool write_at(i64 offset, const char* src_addr, size_t wrsize);
+
+  /**
+   * @brief
+   *
+   * ɢ/ۼλдļϴoffsetʼζӦڴ档
+   * Ĭʵεread_at/write_at
+   */
+  virtual bool readv_at(i64 offset, const IoSlice* slices, size_t cnt);
+
+  virtual bool writev_at(i64 offset, const IoSlice* slices, size_t cnt);
+
+  // ѻڱед뽻ϵͳĬʵʲô
+  virtual bool flush();
+
+  // ϵͳԭļûʱ-1
+  virtual int native_handle();
+
+  // дƫƺͳ˶뵽ֽҪʱΪ1
+  virtual size_t alignment();
+
+ protected:
+  // ¼һʧܡĶλдͬʱʧܣϢ
+  void set_error(const std::string& msg);
+
+  // ȡϢָ״̬
+  std::string take_error();
+
  protected:
   std::string file_path_;
   std::string error_;
-  i32 is_good_ = 1;
+  std::atomic<i32> is_good_{1};
+  std::mutex error_lock_;
+  // Ĭ϶λдʵʹõα
+  std::mutex cursor_lock_;
 };
 
 };  // namespace io
@@ -45,6 +45,8 @@ class FstreamFile : public FileBase {
 
   virtual std::string error() override;
 
+  virtual bool flush() override;
+
  protected:
   std::fstream stream_;
 };
@@ -0,0 +1,69 @@
+/**
+ * @file io_mmap_file.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 10:12:36
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef IO_MMAP_FILE_HPP_
+#define IO_MMAP_FILE_HPP_
+
+#include "io_file.hpp"
+
+namespace io {
+
+/**
+ * @brief
+ *
+ * ļӳ䵽ڴĴļʽ
+ *
+ * дֱӳmemcpyλֻ޸α꣬ϵͳá
+ * ӳĴСڴʱȷдԽļĩβ
+ * λд漰α꣬Զ̲߳ʹá
+ */
+class MmapFile : public FileBase {
+ public:
+  explicit MmapFile(const std::string& filepath);
+
+  virtual ~MmapFile();
+
+  virtual FileBase& read(char* dest_addr, size_t rdsize) override;
+
+  virtual FileBase& write(const char* src_addr, size_t wrsize) override;
+
+  virtual FileBase& seekg(i32 offset, u32 seekdir) override;
+
+  virtual FileBase& seekp(i32 offset, u32 seekdir) override;
+
+  virtual i32 tellg() override;
+
+  virtual i32 tellp() override;
+
+  virtual bool good() override;
+
+  virtual std::string error() override;
+
+  virtual bool read_at(i64 offset, char* dest_addr, size_t rdsize) override;
+
+  virtual bool write_at(i64 offset, const char* src_addr,
+                        size_t wrsize) override;
+
+ protected:
+  i64 seek(i64 pos, i32 offset, u32 seekdir);
+
+ protected:
+  int fd_ = -1;
+  byte* data_ = nullptr;
+  i64 size_ = 0;
+  // дα꣬ԽΪ-1fstreamΪһ¡
+  i64 gpos_ = 0;
+  i64 ppos_ = 0;
+};
+
+}  // namespace io
+
+#endif
\ No newline at end of file
@@ -0,0 +1,79 @@
+/**
+ * @file io_posix_file.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 11:02:47
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef IO_POSIX_FILE_HPP_
+#define IO_POSIX_FILE_HPP_
+
+#include "io_file.hpp"
+
+namespace io {
+
+/**
+ * @brief
+ *
+ * ʹPOSIX pread/pwriteʵֵĴļʽ
+ *
+ * λдֻһϵͳãҲ漰α꣬Զ̲߳ʹá
+ * ɢ/ۼдʹpreadv/pwritev
+ * αʽдҲpread/pwriteʵ֣αڶڲά
+ */
+class PosixFile : public FileBase {
+ public:
+  explicit PosixFile(const std::string& filepath);
+
+  virtual ~PosixFile();
+
+  virtual FileBase& read(char* dest_addr, size_t rdsize) override;
+
+  virtual FileBase& write(const char* src_addr, size_t wrsize) override;
+
+  virtual FileBase& seekg(i32 offset, u32 seekdir) override;
+
+  virtual FileBase& seekp(i32 offset, u32 seekdir) override;
+
+  virtual i32 tellg() override;
+
+  virtual i32 tellp() override;
+
+  virtual bool good() override;
+
+  virtual std::string error() override;
+
+  virtual bool read_at(i64 offset, char* dest_addr, size_t rdsize) override;
+
+  virtual bool write_at(i64 offset, const char* src_addr,
+                        size_t wrsize) override;
+
+  virtual bool readv_at(i64 offset, const IoSlice* slices,
+                        size_t cnt) override;
+
+  virtual bool writev_at(i64 offset, const IoSlice* slices,
+                         size_t cnt) override;
+
+  virtual int native_handle() override;
+
+ protected:
+  // direct=trueʱO_DIRECT򿪣DirectFileʹá
+  PosixFile(const std::string& filepath, bool direct);
+
+  i64 seek(i64 pos, i32 offset, u32 seekdir);
+
+  bool transfer_v(i64 offset, const IoSlice* slices, size_t cnt, bool write);
+
+ protected:
+  int fd_ = -1;
+  i64 gpos_ = 0;
+  i64 ppos_ = 0;
+};
+
+}  // namespace io
+
+#endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+/**
+ * @file io_ram_file.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 16:25:37
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef IO_RAM_FILE_HPP_
+#define IO_RAM_FILE_HPP_
+
+#include <mutex>
+#include <vector>
+
+#include "io_file.hpp"
+
+namespace io {
+
+/**
+ * @brief
+ *
+ * ļڴĴļʽ
+ *
+ * ʱһԶȫݣ˺Ķдڴɣ
+ * ֻ¼дΣflush()ʱЩдشļ
+ * дԽļĩβλдԶ̲߳ʹá
+ */
+class RamFile : public FileBase {
+ public:
+  explicit RamFile(const std::string& filepath);
+
+  virtual ~RamFile();
+
+  virtual FileBase& read(char* dest_addr, size_t rdsize) override;
+
+  virtual FileBase& write(const char* src_addr, size_t wrsize) override;
+
+  virtual FileBase& seekg(i32 offset, u32 seekdir) override;
+
+  virtual FileBase& seekp(i32 offset, u32 seekdir) override;
+
+  virtual i32 tellg() override;
+
+  virtual i32 tellp() override;
+
+  virtual bool good() override;
+
+  virtual std::string error() override;
+
+  virtual bool read_at(i64 offset, char* dest_addr, size_t rdsize) override;
+
+  virtual bool write_at(i64 offset, const char* src_addr,
+                        size_t wrsize) override;
+
+  virtual bool flush() override;
+
+ protected:
+  i64 seek(i64 pos, i32 offset, u32 seekdir);
+
+ protected:
+  // дõĴļ
+  FileBase* backing_ = nullptr;
+  std::vector<byte> data_;
+  // ÿ¼ԪǷд
+  std::vector<bool> dirty_;
+  std::mutex dirty_lock_;
+  // дα꣬ԽΪ-1fstreamΪһ¡
+  i64 gpos_ = 0;
+  i64 ppos_ = 0;
+};
+
+}  // namespace io
+
+#endif
\ No newline at end of file
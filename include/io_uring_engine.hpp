@@ -0,0 +1,74 @@
+/**
+ * @file io_uring_engine.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 13:31:17
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef IO_URING_ENGINE_HPP_
+#define IO_URING_ENGINE_HPP_
+
+#include "io_engine.hpp"
+
+namespace io {
+
+/**
+ * @brief
+ *
+ * Linux io_uringд档
+ *
+ * ֱʹϵͳãliburingÿdepth
+ * һͨһio_uring_enterύȴȫɡ
+ * ÿӦһREADV/WRITEVеĶܳIOV_MAX
+ * ƽֻ̨֧ں˾ܾʱ캯׳FileSystemException
+ */
+class UringIoEngine : public IoEngine {
+ public:
+  UringIoEngine(FileBase& file, int fd, u32 depth);
+
+  virtual ~UringIoEngine();
+
+  virtual bool submit() override;
+
+  virtual const char* name() const override;
+
+ protected:
+  void release();
+
+ protected:
+  int fd_ = -1;
+  int ring_fd_ = -1;
+
+  // ύСɶSQEӳ
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  void* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  // ӳڵĸֶΡ
+  u32* sq_head_ = nullptr;
+  u32* sq_tail_ = nullptr;
+  u32* sq_mask_ = nullptr;
+  u32* sq_array_ = nullptr;
+  u32 sq_entries_ = 0;
+  u32* cq_head_ = nullptr;
+  u32* cq_tail_ = nullptr;
+  u32* cq_mask_ = nullptr;
+  void* cqes_ = nullptr;
+
+  // һ;iovec飬READV/WRITEVãݡ
+  void* iovecs_ = nullptr;
+  size_t iovecs_cap_ = 0;
+  // io_uring_enterֲɻָĴ󣬸ͬ·
+  bool is_broken_ = false;
+};
+
+}  // namespace io
+
+#endif
\ No newline at end of file
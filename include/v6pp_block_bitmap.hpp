@@ -0,0 +1,62 @@
+/**
+ * @file v6pp_block_bitmap.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 19:12:26
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef V6PP_BLOCK_BITMAP_HPP_
+#define V6PP_BLOCK_BITMAP_HPP_
+
+#include <vector>
+
+#include "defines.hpp"
+
+namespace v6pp {
+
+/**
+ * @brief
+ *
+ * ̿λͼλʾС
+ *
+ * 64λִ洢ҿпжʱռõ
+ */
+class BlockBitmap {
+ public:
+  explicit BlockBitmap(u32 block_cnt);
+
+  bool is_free(i32 block_idx) const;
+
+  // ޸ĵ̿״̬״̬Ƿĸı䡣
+  bool mark_free(i32 block_idx);
+  bool mark_used(i32 block_idx);
+
+  // ȫΪռá
+  void clear();
+
+  // [from, to)еһп飬ûʱ-1
+  i32 find_free(i32 from, i32 to) const;
+
+  // [from, to)еһռÿ飬ûʱto
+  i32 find_used(i32 from, i32 to) const;
+
+  // [from, to)еһγȲСlenп㣬ûʱ-1
+  i32 find_run(i32 len, i32 from, i32 to) const;
+
+  u32 free_count() const;
+
+  u32 size() const;
+
+ protected:
+  u32 block_cnt_;
+  u32 free_cnt_ = 0;
+  std::vector<u64> words_;
+};
+
+}  // namespace v6pp
+
+#endif
\ No newline at end of file
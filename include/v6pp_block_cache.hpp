@@ -0,0 +1,108 @@
+/**
+ * @file v6pp_block_cache.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 17:02:45
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef V6PP_BLOCK_CACHE_HPP_
+#define V6PP_BLOCK_CACHE_HPP_
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "defines.hpp"
+
+namespace v6pp {
+
+/**
+ * @brief
+ *
+ * ̿黺棬CLOCK㷨û
+ *
+ * ·Ŀ鲻ʱǣֻٴеĿŻһɨб
+ * ˳дļʱ顢Ŀ¼ȼ档
+ * ڱûflush()ʱwriteback_дء
+ * в̰߳ȫġ
+ */
+class BlockCache {
+ public:
+  using BlockRef = std::pair<i32, const char*>;
+  // Ӵļɿ顣
+  using Reader = std::function<bool(i32 block_idx, i32 block_cnt, char* dest)>;
+
+ public:
+  explicit BlockCache(u32 capacity);
+
+  BlockCache(const BlockCache&) = delete;
+
+  // ʱѿݸƵdesttrue
+  bool lookup(i32 block_idx, char* dest);
+
+  // 򸲸һ顣dirtyʾÿδдش̡
+  bool insert(i32 block_idx, const char* src, bool dirty);
+
+  // readerδĿ飬ѻĿ鱣ֲ䡣Ԥ
+  bool fill(i32 block_idx, i32 block_cnt, const Reader& reader);
+
+  // ֻѻʱݣƹд롣
+  void refresh(i32 block_idx, const char* src);
+
+  // һ飬дء
+  void invalidate(i32 block_idx);
+
+  // ȫ飬дء
+  void clear();
+
+  // ˳дȫ顣
+  bool flush();
+
+  u32 capacity() const;
+
+  u64 hits() const;
+
+  u64 misses() const;
+
+ public:
+  // дعӣ밴ɿ飬ȫдɹʱtrue
+  std::function<bool(const std::vector<BlockRef>& blocks)> writeback_ =
+      [](const std::vector<BlockRef>&) { return true; };
+
+ protected:
+  struct Entry {
+    i32 block_idx_;
+    bool dirty_;
+    bool referenced_;
+  };
+
+  // һղۻûһ飬زۺš
+  bool evict(u32& slot);
+
+  // insert()ʵ֣
+  bool insert_locked(i32 block_idx, const char* src, bool dirty);
+
+  char* slot_data(u32 slot);
+
+ protected:
+  u32 capacity_;
+  std::vector<Entry> entries_;
+  std::vector<char> data_;
+  // ŵۺŵӳ䡣
+  std::unordered_map<i32, u32> slots_;
+  // CLOCKָ롣
+  u32 hand_ = 0;
+  u64 hits_ = 0;
+  u64 misses_ = 0;
+  mutable std::mutex lock_;
+};
+
+}  // namespace v6pp
+
+#endif
\ No newline at end of file
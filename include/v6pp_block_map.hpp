@@ -0,0 +1,60 @@
+/**
+ * @file v6pp_block_map.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 22:40:18
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef V6PP_BLOCK_MAP_HPP_
+#define V6PP_BLOCK_MAP_HPP_
+
+#include <vector>
+
+#include "defines.hpp"
+
+namespace v6pp {
+
+/**
+ * @brief
+ *
+ * ļ߼ŵŵӳ䡣
+ *
+ * һ̿õ߼Ϻ϶ɿϲΪһΡ
+ * ΰ߼Уҵʱ֡
+ */
+class BlockMap {
+ public:
+  struct Extent {
+    i32 logical_;
+    i32 physical_;
+    i32 length_;
+  };
+
+ public:
+  // ׷һ飬logicalе߼š
+  void append(i32 logical, i32 physical);
+
+  void clear();
+
+  // ߼Ӧţӳʱ-1
+  i32 lookup(i32 logical) const;
+
+  // logicalĶε±꣬ûʱ-1
+  i32 find(i32 logical) const;
+
+  const std::vector<Extent>& extents() const;
+
+  // ӳʱļĴСжӳǷڡ
+  i32 fsize_ = -1;
+
+ protected:
+  std::vector<Extent> extents_;
+};
+
+}  // namespace v6pp
+
+#endif
@@ -13,20 +13,63 @@
 #define V6PP_DISK_HPP_
 
 #include <functional>
+#include <map>
+#include <unordered_map>
 #include <memory>
 #include <vector>
 
 #include "defines.hpp"
 #include "exceptions.hpp"
+#include "io_aligned_pool.hpp"
+#include "io_engine.hpp"
 #include "io_file.hpp"
 #include "v6pp_block.hpp"
+#include "v6pp_block_bitmap.hpp"
+#include "v6pp_block_cache.hpp"
+#include "v6pp_block_map.hpp"
 #include "v6pp_inode.hpp"
 #include "v6pp_inode_directory.hpp"
+#include "v6pp_readahead.hpp"
 #include "v6pp_superblock.hpp"
 
 
 namespace v6pp {
 
+/**
+ * @brief
+ *
+ * ̶в
+ */
+class DiskConfig {
+ public:
+  // ļĶдˡ
+  enum FileBackend {
+    FSTREAM,  // C++׼fstream
+    MMAP,     // ļӳ䵽ڴ
+    POSIX,    // POSIX pread/pwrite
+    DIRECT,   // O_DIRECTƹҳ
+    RAM,      // ļڴ棬رʱд
+    MAX,
+  };
+
+ public:
+  // ѡдˣЧʱfalse
+  bool set_backend(const std::string& name);
+
+ public:
+  FileBackend backend_ = FSTREAM;
+  // дĶȣ0ʾʹ첽档
+  u32 io_depth_ = 64;
+  // ̿黺0ʾʹû档
+  u32 cache_blocks_ = 1024;
+  // ˳ԤĴڣ0ʾԤҪ̿黺档
+  u32 readahead_blocks_ = 128;
+  // ̿黺0ʾ档
+  u32 index_cache_blocks_ = 256;
+  // ӳٷʱ໺ļݣֽڣ0ʾдļʱ̿顣
+  u32 delay_alloc_bytes_ = 0;
+};
+
 class DiskBlockTraversalMixin {
  public:
   // ̿
@@ -50,6 +93,34 @@ class DiskBlockTraversalMixin {
   // ϴ
   std::function<void(Inode& inode, i32 size_remaining, const std::string& msg)>
       failure_handler_ = [](...) {};
+
+  // Ƿѱ̿齻ԤֻʱӦ򿪡
+  bool read_ahead_ = false;
+};
+
+/**
+ * @brief
+ *
+ * ̿ķ߻࣬ĬʲôҲ
+ *
+ * ֻ趨õĹӣͬڱλİ汾
+ * traverse_blocks()ߵľ̬͵ùӣδĹ󲻲롣
+ * ӵĺDiskBlockTraversalMixinеͬԱͬ
+ */
+class BlockVisitor {
+ public:
+  i32 allocate(i32 old_block_idx) { return old_block_idx; }
+
+  void direct_setup(i32, i32) {}
+  void direct_process(i32, i32) {}
+  void direct_teardown(i32, i32) {}
+
+  void indirect_setup(const char*, i32) {}
+  void indirect_teardown(const char*, i32) {}
+
+  void failure(Inode&, i32, const std::string&) {}
+
+  bool read_ahead() const { return false; }
 };
 
 class DiskInodeTravesalMixin {
@@ -62,7 +133,10 @@ class DiskInodeTravesalMixin {
 
  public:
   TraverseOrder order_ = PRE_ORDER;
-  // ˳ӡ
+  // ߳0ʾӲ߳ѡ
+  // 1߳ʱӲִУҲ޸Ĵ̶
+  u32 threads_ = 1;
+  // ˳ӣtrueʱfather_idxΪ-1
   std::function<bool(i32 cur_idx, i32 father_idx)> traverse_border_ = [](...) {
     return false;
   };
@@ -91,9 +165,12 @@ class Disk {
   static constexpr u32 IDX_ROOT_INODE = 1u;
   static constexpr u32 FSIZE_MAX =
       DiskProps::BLOCK_SIZE * (6 + 2 * 128 + 2 * 128 * 128);
+  // ÿ̿ɵinode
+  static constexpr u32 INODES_PER_BLOCK = DiskProps::BLOCK_SIZE / sizeof(Inode);
 
  public:
-  explicit Disk(const std::string& filepath);
+  explicit Disk(const std::string& filepath,
+                const DiskConfig& config = DiskConfig());
 
   ~Disk();
 
@@ -112,19 +189,91 @@ class Disk {
    * @brief
    *
    * ̿д
+   * ûʱдڻУupdate()ʱдء
    */
   bool read_block(Block& block, i32 block_idx);
   bool read_blocks(char* dest, i32 block_idx, i32 block_cnt);
   bool write_block(const Block& block, i32 block_idx);
   bool write_blocks(const char* src, i32 block_idx, i32 block_cnt);
 
+  /**
+   * @brief
+   *
+   * д
+   * Ŷsubmit_blocks()һύȴȫɡ
+   * ύʱڵĿϲΪһηɢ/ۼд
+   * ŶӵĻύǰ뱣ЧͬһвӦظдͬһ顣
+   */
+  void queue_read_blocks(char* dest, i32 block_idx, i32 block_cnt);
+  void queue_write_blocks(const char* src, i32 block_idx, i32 block_cnt);
+  bool submit_blocks();
+  void discard_blocks();
+  // ĵ
+  i32 io_depth() const;
+
+  /**
+   * @brief
+   *
+   * ɢ/ۼдÿһһż䵥黺
+   * ൱ŶӺύһύǰŶӵ
+   */
+  using BlockBuffer = std::pair<i32, char*>;
+  using ConstBlockBuffer = std::pair<i32, const char*>;
+  bool read_blocks_v(const std::vector<BlockBuffer>& blocks);
+  bool write_blocks_v(const std::vector<ConstBlockBuffer>& blocks);
+
   /**
    * @brief
    *
    * ļд
+   *
+   * ӳٷʱwrite_file()ֻ¼ļСݣ
+   * ̿flush_delayed()ʱļܴСһη䣬дļš
+   * ݳޡļ̿update()ʱԶд롣
    */
   bool read_file(char* dest, Inode& inode);
+  // ļĿӳ䡣inodeеļӳ䱻棬ʱĶʧЧ
+  const BlockMap& block_map(Inode& inode);
+  void invalidate_block_map(const Inode& inode);
   bool write_file(const char* src, Inode& inode, i32 fsize);
+  void flush_delayed();
+
+  /**
+   * @brief
+   *
+   * ƫƶдļһֻ֣д[offset, offset + len)ݿ顣
+   * ̿λȡblock_map()ļ״ΰƫƷʻӳʧЧ
+   * ȱȫ齨ļӳ䣬֮ķֻӳ䡣
+   * ȡԽļĩβʱض̣ʵʶȡֽд벻Խļĩβ
+   * ĲֱӶдβĿȶ޸ġ
+   */
+  i32 read_at(Inode& inode, i32 offset, i32 len, char* buf);
+  i32 write_at(Inode& inode, i32 offset, i32 len, const char* buf);
+  // дļĵblock飬ԽļĩβĲҲд룬ȶ
+  void write_block_at(Inode& inode, i32 block, const char* buf);
+  // ļԭݣΪfsizeֽԤ̿顣̿δ塣
+  void reserve_file(Inode& inode, i32 fsize);
+
+  /**
+   * @brief
+   *
+   * ıļСдļ
+   * append()ֻдһĿ̿飬ֻдиĶ̿顣
+   * truncate()ֻͷ´С̿飻´Сʱ0롣
+   */
+  void append(Inode& inode, const char* src, i32 len);
+  void truncate(Inode& inode, i32 new_size);
+
+  /**
+   * @brief
+   *
+   * ޸ļ¼update()ֻдرǹinodeڵ̿飬
+   * Ҳֻs_fmod_λʱдء
+   * Diskֱ޸inodes_superblock_󣬱Ӧĺ
+   */
+  void mark_inode_dirty(i32 inode_idx);
+  void mark_inode_dirty(const Inode& inode);
+  void mark_superblock_dirty();
 
   /**
    * @brief
@@ -132,10 +281,28 @@ class Disk {
    * ̿InodeԴ
    */
   i32 alloc_block();
+  i32 alloc_extent(i32 block_cnt);
+  bool alloc_blocks(i32 block_cnt, std::vector<i32>& out);
   void free_block(i32 idx);
+  void free_blocks(const std::vector<i32>& blocks);
+  // fsizeֽڵļ̿顣
+  static i32 blocks_for_size(i32 fsize);
+  // V6++̿̿λͼѽʱʲôҲ
+  void load_free_map();
+  // inodeѯO(1)ġͷ
+  // ά̿λͼǰʹó¼Ŀ̿
+  // ֻм¼ʧЧ(羵Ķ)ʱű
+  u32 total_block_count() const;
+  u32 free_block_count();
+  u32 total_inode_count() const;
+  u32 free_inode_count() const;
   i32 alloc_inode();
   void free_inode(i32 idx, bool free_blocks = false);
   void free_inode_blocks(Inode& inode);
+  // ļ̿вĶҲڡ
+  i32 count_fragments(Inode& inode);
+  // ļᵽһĿ̿УǷᶯ
+  bool defrag_inode(Inode& inode);
 
   /**
    * @brief
@@ -143,6 +310,9 @@ class Disk {
    * ̿inode
    *
    */
+  template <typename Visitor>
+  bool traverse_blocks(Inode& inode, Visitor& visitor);
+  // std::functionӱtraverse_blocks()䡣
   bool traverse_blocks_over_inode(Inode& inode,
                                   const DiskBlockTraversalMixin& mixin);
   bool traverse_inode_tree(Inode& root, const DiskInodeTravesalMixin& mixin);
@@ -150,9 +320,106 @@ class Disk {
   std::unique_ptr<InodeDirectory> read_inode_directory(
       Inode& inode, bool ignore_ftype_check = false, int dir_stride = 0);
 
+ protected:
+  void check_block_args(const char* caller, const void* buf, i32 block_idx,
+                        i32 block_cnt);
+
+  // ŶеĿд
+  struct PendingBlocks {
+    i32 block_idx_;
+    i32 block_cnt_;
+    char* buf_;
+  };
+
+  // Ŷӵϲ󽻸档
+  void merge_pending(std::vector<PendingBlocks>& pending, bool write);
+
+  // ύǰ뻺ͬд»棬еĶֱӴӻ渴ơ
+  void sync_pending_with_cache();
+  void fill_cache_from_pending(const std::vector<PendingBlocks>& reads,
+                               const std::vector<PendingBlocks>& writes);
+
+  // inodeinodes_е±꣬ڱʱ-1
+  i32 inode_index(const Inode& inode) const;
+
+  // index_cache_ȡһ̿飬ȡʧʱ׳쳣
+  void read_index_block(u32* dest, i32 block_idx);
+  // ѱдindex_cache_
+  void store_index_block(const u32* src, i32 block_idx);
+
+  // Ԥ̿дļreservedblocks_for_size(fsize)
+  // srcΪnullptrʱֻдݿ顣
+  bool write_file_blocks(const char* src, Inode& inode, i32 fsize,
+                         const i32* reserved);
+
+  // ˳гļȫ̿飬顣
+  std::vector<i32> list_inode_blocks(Inode& inode);
+
+  // read_at()write_at()ʵ֡
+  void transfer_at(Inode& inode, i32 offset, i32 len, char* buf, bool write);
+
+  // д뵥ļĻݣûʱʲôҲ
+  void flush_delayed(Inode& inode);
+
+  // Ԥ̿дһļʧʱ׳쳣
+  // Ԥ̿ɵ߹黹
+  void write_delayed(i32 inode_idx, const std::vector<char>& data,
+                     const i32* reserved);
+
+  // ļĻݣظļǷлݡ
+  bool drop_delayed(i32 inode_idx);
+
+  // block_cntʣ̿鲻ļʹʱд뻺ļ
+  void reserve_for_delayed(i32 block_cnt);
+
+  // дعӡ
+  bool write_back_blocks(const std::vector<BlockCache::BlockRef>& blocks);
+
+  // ѿ̿λͼдV6++̿
+  void store_free_map();
+
+  // inodes_ؽinodeλͼ
+  void build_inode_map();
+
+ protected:
+  std::vector<PendingBlocks> pending_reads_;
+  std::vector<PendingBlocks> pending_writes_;
+  // inodeи̿Ƿ޸ġ
+  std::vector<bool> inode_dirty_;
+  // ̿λͼǷԼǷ޸ġ
+  bool free_map_loaded_ = false;
+  bool free_map_dirty_ = false;
+  // һη俪ʼҵλá
+  i32 alloc_cursor_ = 0;
+  // δ̿ļݣinodeС
+  std::map<i32, std::vector<char>> delayed_;
+  size_t delayed_bytes_ = 0;
+  // ļдʱҪ̿
+  i32 delayed_blocks_ = 0;
+  // ļĿӳ䣬inode
+  std::unordered_map<i32, BlockMap> block_maps_;
+  // inodeеĸĿӳ䣬档
+  BlockMap scratch_map_;
+
  public:
+  // ̲
+  DiskConfig config_;
   // ļ
   io::FileBase* file_;
+  // д档
+  io::IoEngine* engine_;
+  // ̿黺棬δʱΪnullptr
+  BlockCache* cache_;
+  // ˳ԤδʱΪnullptr
+  ReadAhead* readahead_;
+  // ̿黺棬ֻڱʹãݿĳˢδʱΪnullptr
+  BlockCache* index_cache_;
+  // 뻺أÿio_depth()̿顣
+  io::AlignedBufferPool pool_;
+  // ̿λͼ״ηͷ̿ʱ
+  BlockBitmap free_map_;
+  // inodeλͼinodes_ͬάĿ¼֮ǰinode䡣
+  BlockBitmap inode_map_;
   // ڴ渱
   SuperBlock superblock_;
   // Inodeڴ渱
@@ -160,6 +427,199 @@ class Disk {
                 sizeof(Inode)];
 };
 
+/**
+ * @brief
+ *
+ * inodeڱݿ顣
+ *
+ * ̿ȴindex_cache_ȡĶĳ̿ıʱ
+ * indirect_teardown()ֱ֮дindex_cache_
+ * ĶκʱӳʧЧ
+ *
+ * ATTENTION:
+ * Ĭϲд̿顣
+ * Ҫ޸ļindirect_teardown()д̿飬
+ * index_cache_̲һ¡
+ */
+template <typename Visitor>
+bool Disk::traverse_blocks(Inode& inode, Visitor& visitor) {
+  // һЩ
+  static const i32 ENTRIES_PER_BLOCK = sizeof(Block) / sizeof(u32);
+  static const i32 IDXS_DIRECT = 6;
+  static const i32 IDXS_L1 = 2;
+  static const i32 IDXS_L2 = 2;
+
+  // δ̿ļд̡
+  if (!delayed_.empty()) flush_delayed(inode);
+  i32 size_remaining = inode.d_size_;
+  // ǷĶԼǰһ̿ı
+  bool changed = false;
+  bool l1_changed = false;
+  bool l2_changed = false;
+  u32 idx_block_l1[ENTRIES_PER_BLOCK];
+  u32 idx_block_l2[ENTRIES_PER_BLOCK];
+
+  try {
+    /**
+     * @brief
+     *
+     * 6ֱ̿顣
+     */
+    for (i32 idx = 0; size_remaining > 0 && idx < IDXS_DIRECT; ++idx) {
+      // ѡԸֱĬϲ¡
+      i32 new_blk_idx = visitor.allocate(inode.idx_direct_[idx]);
+      if (new_blk_idx < 0)
+        throw FileSystemException(
+            "direct block allocation failed while traversing");
+      if (inode.idx_direct_[idx] != u32(new_blk_idx)) {
+        mark_inode_dirty(inode);
+        changed = true;
+      }
+      inode.idx_direct_[idx] = new_blk_idx;
+      if (visitor.read_ahead() && readahead_)
+        readahead_->observe(inode.idx_direct_[idx]);
+      // ݿһֻú
+      visitor.direct_setup(idx * sizeof(Block), inode.idx_direct_[idx]);
+      visitor.direct_process(idx * sizeof(Block), inode.idx_direct_[idx]);
+      visitor.direct_teardown(idx * sizeof(Block), inode.idx_direct_[idx]);
+
+      size_remaining -= sizeof(Block);
+    }
+
+    /**
+     * @brief
+     *
+     * 2һ̿顣
+     */
+    for (i32 idx1 = 0; idx1 < IDXS_L1 && size_remaining > 0; ++idx1) {
+      // ѡԸһĬϲ¡
+      i32 new_blk_idx = visitor.allocate(inode.idx_indirect_[idx1]);
+      if (new_blk_idx < 0)
+        throw FileSystemException(
+            "indirect block allocation failed while traversing");
+      if (inode.idx_indirect_[idx1] != u32(new_blk_idx)) {
+        mark_inode_dirty(inode);
+        changed = true;
+      }
+      inode.idx_indirect_[idx1] = new_blk_idx;
+
+      // ̿鵽顣
+      if (visitor.read_ahead() && readahead_)
+        readahead_->observe(inode.idx_indirect_[idx1]);
+      read_index_block(idx_block_l1, inode.idx_indirect_[idx1]);
+      visitor.indirect_setup((char*)idx_block_l1,
+                                  inode.idx_indirect_[idx1]);
+      // һݿ顣
+      l1_changed = false;
+      for (i32 idx = 0; idx < ENTRIES_PER_BLOCK && size_remaining > 0; ++idx) {
+        i32 new_blk_idx = visitor.allocate(idx_block_l1[idx]);
+        if (new_blk_idx < 0)
+          throw FileSystemException(
+              "direct block allocation failed while traversing (under indirect "
+              "block)");
+        if (idx_block_l1[idx] != u32(new_blk_idx)) changed = l1_changed = true;
+        idx_block_l1[idx] = new_blk_idx;
+
+        u32 blk_offset = DiskProps::BLOCK_SIZE *
+                         (IDXS_DIRECT + ENTRIES_PER_BLOCK * idx1 + idx);
+        if (visitor.read_ahead() && readahead_)
+          readahead_->observe(idx_block_l1[idx]);
+
+        visitor.direct_setup(blk_offset, idx_block_l1[idx]);
+        visitor.direct_process(blk_offset, idx_block_l1[idx]);
+        visitor.direct_teardown(blk_offset, idx_block_l1[idx]);
+
+        size_remaining -= sizeof(Block);
+      }  // for(idx)
+      visitor.indirect_teardown((char*)idx_block_l1, new_blk_idx);
+      if (l1_changed) store_index_block(idx_block_l1, new_blk_idx);
+    }  // for(idx1)
+
+    /**
+     * @brief
+     *
+     * 2̿顣
+     */
+    for (i32 idx2 = 0; idx2 < IDXS_L2 && size_remaining > 0; ++idx2) {
+      // ѡԸ¶Ĭϲ¡
+      i32 new_blk_idx =
+          visitor.allocate(inode.idx_secondary_indirect_[idx2]);
+      if (new_blk_idx < 0)
+        throw FileSystemException(
+            "secondary indirect block allocation failed while traversing");
+      if (inode.idx_secondary_indirect_[idx2] != u32(new_blk_idx)) {
+        mark_inode_dirty(inode);
+        changed = true;
+      }
+      inode.idx_secondary_indirect_[idx2] = new_blk_idx;
+
+      if (visitor.read_ahead() && readahead_)
+        readahead_->observe(inode.idx_secondary_indirect_[idx2]);
+      read_index_block(idx_block_l2, inode.idx_secondary_indirect_[idx2]);
+      visitor.indirect_setup((char*)idx_block_l2,
+                                  inode.idx_secondary_indirect_[idx2]);
+
+      // һ
+      l2_changed = false;
+      for (i32 idx1 = 0; idx1 < ENTRIES_PER_BLOCK && size_remaining > 0;
+           ++idx1) {
+        // ѡԸһĬϲ¡
+        i32 new_blk_idx = visitor.allocate(idx_block_l2[idx1]);
+        if (new_blk_idx < 0)
+          throw FileSystemException(
+              "indirect block allocation failed while traversing (under "
+              "secondary indirect block)");
+        if (idx_block_l2[idx1] != u32(new_blk_idx)) changed = l2_changed = true;
+        idx_block_l2[idx1] = new_blk_idx;
+
+        if (visitor.read_ahead() && readahead_)
+          readahead_->observe(idx_block_l2[idx1]);
+        read_index_block(idx_block_l1, idx_block_l2[idx1]);
+        visitor.indirect_setup((char*)idx_block_l1, idx_block_l2[idx1]);
+
+        // һݿ顣
+        l1_changed = false;
+        for (i32 idx = 0; size_remaining > 0 && idx < ENTRIES_PER_BLOCK;
+             ++idx) {
+          i32 new_blk_idx = visitor.allocate(idx_block_l1[idx]);
+          if (new_blk_idx < 0)
+            throw FileSystemException(
+                "direct block allocation failed while traversing (under "
+                "secondary indirect block)");
+          if (idx_block_l1[idx] != u32(new_blk_idx))
+            changed = l1_changed = true;
+          idx_block_l1[idx] = new_blk_idx;
+
+          u32 blk_offset = DiskProps::BLOCK_SIZE *
+                           (IDXS_DIRECT + IDXS_L1 * ENTRIES_PER_BLOCK +
+                            idx2 * ENTRIES_PER_BLOCK * ENTRIES_PER_BLOCK +
+                            idx1 * ENTRIES_PER_BLOCK + idx);
+          if (visitor.read_ahead() && readahead_)
+            readahead_->observe(idx_block_l1[idx]);
+
+          visitor.direct_setup(blk_offset, idx_block_l1[idx]);
+          visitor.direct_process(blk_offset, idx_block_l1[idx]);
+          visitor.direct_teardown(blk_offset, idx_block_l1[idx]);
+
+          size_remaining -= sizeof(Block);
+        }  // for(idx)
+        visitor.indirect_teardown((char*)idx_block_l1, new_blk_idx);
+        if (l1_changed) store_index_block(idx_block_l1, new_blk_idx);
+      }  // for(idx1)
+
+      visitor.indirect_teardown((char*)idx_block_l2, new_blk_idx);
+      if (l2_changed) store_index_block(idx_block_l2, new_blk_idx);
+    }  // for(idx2)
+
+    if (changed) invalidate_block_map(inode);
+    return true;
+  } catch (FileSystemException& e) {
+    if (changed) invalidate_block_map(inode);
+    visitor.failure(inode, size_remaining, e.what());
+    return false;
+  }
+}
+
 }  // namespace v6pp
 
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+/**
+ * @file v6pp_file_handle.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 23:26:52
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef V6PP_FILE_HANDLE_HPP_
+#define V6PP_FILE_HANDLE_HPP_
+
+#include "defines.hpp"
+#include "v6pp_block.hpp"
+#include "v6pp_disk.hpp"
+#include "v6pp_inode.hpp"
+
+namespace v6pp {
+
+/**
+ * @brief
+ *
+ * 򿪵ļждλá
+ *
+ * дDisk::read_at()write_at()̿λɴ̶󻺴Ŀӳ
+ * ӳ״ζдʱ彨֮󲻱ÿδͷ顣
+ * ĿдھĻУͬһ̵СдϲΪһΣ
+ * ƵĿ顢ȡصķΧflush()رʱдء
+ * ˳ȡʱread_at()ѷʵ̿齻̶Ԥ
+ * Խļĩβд뾭Disk::append()׷ӣļDisk::reserve_file()
+ * ȷС
+ */
+class FileHandle {
+ public:
+  enum Whence {
+    SET,  // ļͷ
+    CUR,  // Եǰλ
+    END,  // ļĩβ
+  };
+
+ public:
+  FileHandle(Disk& disk, Inode& inode);
+
+  ~FileHandle();
+
+  FileHandle(const FileHandle&) = delete;
+
+  // ӵǰλöдʵʶдֽ
+  i32 read(char* buf, i32 len);
+  i32 write(const char* buf, i32 len);
+
+  // ƶдλãµλá
+  i32 seek(i32 offset, Whence whence = SET);
+  i32 tell() const;
+
+  i32 size() const;
+
+  Inode& inode();
+
+  // дػ顣
+  void flush();
+
+  // дػ鲢رգ֮ٶд
+  void close();
+
+ protected:
+  void check_open(const char* caller) const;
+
+ protected:
+  Disk& disk_;
+  Inode* inode_;
+  i32 pos_ = 0;
+
+  // ߼ţ-1ʾûл顣
+  i32 buffered_ = -1;
+  // б޸ĵֽڷΧ[dirty_lo_, dirty_hi_)
+  i32 dirty_lo_ = 0;
+  i32 dirty_hi_ = 0;
+  Block block_;
+};
+
+}  // namespace v6pp
+
+#endif
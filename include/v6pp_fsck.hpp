@@ -0,0 +1,89 @@
+/**
+ * @file v6pp_fsck.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 21:12:36
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef V6PP_FSCK_HPP_
+#define V6PP_FSCK_HPP_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "defines.hpp"
+#include "v6pp_disk.hpp"
+
+namespace v6pp {
+
+/**
+ * @brief
+ *
+ * ļϵͳһԼ
+ *
+ * ӸĿ¼Disk::traverse_inode_tree()̲߳бĿ¼
+ * ÿļõݿ빲ԭλͼ
+ * ͬʱ˳ͳÿinodeĿ¼õĴ
+ * ̿λͼialloc_һȶԣ⣺
+ * - δҲе̿飨й©ԼȴΪе̿飻
+ * - õ̿飬Լ̿ţ
+ * - ѷȴɴinodeԼȴδinode
+ * - d_nlink_Ŀ¼ôinode
+ *
+ * ڼ䲻߳޸Ĵ̶
+ */
+class DiskChecker {
+ public:
+  // threadsΪ0ʱӲ߳ѡ
+  explicit DiskChecker(Disk& disk, u32 threads = 0);
+
+  DiskChecker(const DiskChecker&) = delete;
+
+  // ļϵͳطֵ
+  u32 check();
+
+  const std::vector<std::string>& problems() const;
+
+  // ɴinodeͱõ̿
+  u32 inodes_reached() const;
+  u32 blocks_referenced() const;
+
+ protected:
+  // λԭֵ
+  static bool test_and_set(std::vector<std::atomic<u64>>& bitmap, u32 idx);
+  static bool test(const std::vector<std::atomic<u64>>& bitmap, u32 idx);
+
+  // ¼һĿ¼õinodetrueʱ룺Ѿ򲻺Ϸ
+  bool visit_entry(i32 inode_idx, i32 father_idx);
+
+  // ¼һinode̿飬𻵵ԭʱؿմ
+  std::string check_inode(i32 inode_idx);
+
+  void mark_block(i32 inode_idx, i32 block_idx);
+
+  void report(const std::string& msg);
+
+ protected:
+  Disk& disk_;
+  u32 threads_;
+  i32 inode_cnt_;
+
+  // ù̿Ϳɴinode
+  std::vector<std::atomic<u64>> block_refs_;
+  std::vector<std::atomic<u64>> inode_reached_;
+  // inodeĿ¼õĴ
+  std::vector<std::atomic<i32>> inode_links_;
+
+  std::vector<std::string> problems_;
+  std::mutex problems_lock_;
+};
+
+}  // namespace v6pp
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * @file v6pp_readahead.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 18:04:11
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef V6PP_READAHEAD_HPP_
+#define V6PP_READAHEAD_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "defines.hpp"
+#include "v6pp_block_cache.hpp"
+
+namespace v6pp {
+
+/**
+ * @brief
+ *
+ * ˳Ԥ
+ *
+ * ۲ļʱηʵ̿ţݼʱ
+ * ɺ̨̰߳ͬϵĺwindow̿̿黺档
+ * V6++Ŀ̿ջʽģдļŵݼУ
+ * Ҫʶ
+ */
+class ReadAhead {
+ public:
+  ReadAhead(BlockCache& cache, u32 window);
+
+  ~ReadAhead();
+
+  ReadAhead(const ReadAhead&) = delete;
+
+  // ¼һ̿ʣҪʱԤֻӦһ̵߳á
+  void observe(i32 block_idx);
+
+  // δִеԤ󣬲ȴִе
+  void drain();
+
+  // ѷԤ
+  u64 issued() const;
+
+ public:
+  // ̹ӣӴļɿ顣
+  BlockCache::Reader reader_ = [](i32, i32, char*) { return false; };
+
+ protected:
+  void worker();
+
+ protected:
+  BlockCache& cache_;
+  i32 window_;
+
+  // ģʽɵobserve()߳ʹá
+  i32 last_block_ = -1;
+  i32 stride_ = 0;
+  // ͬѾԤı߽磨
+  i32 frontier_ = -1;
+  u64 issued_ = 0;
+
+  // ִеԤʼźͿ
+  std::deque<std::pair<i32, i32>> requests_;
+  bool busy_ = false;
+  bool stop_ = false;
+  mutable std::mutex lock_;
+  std::condition_variable cond_;
+  std::thread thread_;
+};
+
+}  // namespace v6pp
+
+#endif
\ No newline at end of file
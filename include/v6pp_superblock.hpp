@@ -37,6 +37,8 @@ class SuperBlock {
   bool update(io::FileBase& file);
   // ó飬ڸʽ
   void format();
+  // п̿УֵΪ0
+  u32 free_list_checksum() const;
 
  public:
   /**
@@ -96,8 +98,13 @@ class SuperBlock {
   // ǩΪ˷ֹɵĴ̻
   // OFFSET: 19364H
   char p_sign_[64] = "Unix V6++ Diskfile by FsWizard, 2053642 Boyu Li";
+  // ̿ɿ̿ʱ¼ȥͳʱ
+  u32 p_free_blocks_ = 0;
+  // ¼p_free_blocks_ʱУֵĶʱ
+  // ¼֮ϡ
+  u32 p_free_check_ = 0;
   // ;
-  u32 p_blank_[23] = {0};
+  u32 p_blank_[21] = {0};
 } __attribute__((packed));
 
 }  // namespace v6pp
@@ -0,0 +1,109 @@
+/**
+ * @file v6pp_tree_walker.hpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 23:58:14
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef V6PP_TREE_WALKER_HPP_
+#define V6PP_TREE_WALKER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "defines.hpp"
+#include "v6pp_disk.hpp"
+
+namespace v6pp {
+
+/**
+ * @brief
+ *
+ * ļĿ¼Disk::traverse_inode_tree()ʵ֡
+ *
+ * ÿĿ¼һ񣺶Ŀ¼еļfile_handler_
+ * Ŀ¼Ϊ뵱ǰ̵߳˫˶С̴߳Լеβȡ
+ * ԼĶΪʱ̶߳еͷȡ
+ * ʱÿ¼δɵĿ¼һĿ¼ɺ
+ * ŵøĿ¼directory_handler_
+ *
+ * ̱߳ǰдȫӳٷļ̶ֻ
+ */
+class InodeTreeWalker {
+ public:
+  InodeTreeWalker(Disk& disk, const DiskInodeTravesalMixin& mixin);
+
+  InodeTreeWalker(const InodeTreeWalker&) = delete;
+
+  // root_idxĿ¼ȡʧܻ׳쳣ʱfalse
+  bool walk(i32 root_idx);
+
+ protected:
+  struct Task {
+    i32 inode_idx_;
+    i32 father_idx_;
+    Task* parent_;
+    // δɵĿ¼ӱĿ¼һݡ
+    std::atomic<i32> pending_;
+  };
+
+  struct Worker {
+    std::mutex lock_;
+    std::deque<Task*> tasks_;
+    // ̴߳񣬱ʱͳһͷš
+    std::vector<std::unique_ptr<Task>> owned_;
+  };
+
+  void run(u32 self);
+
+  // ȡԼеβȡеͷ
+  Task* take(u32 self);
+
+  Task* spawn(u32 self, i32 inode_idx, i32 father_idx, Task* parent);
+
+  void execute(u32 self, Task* task);
+
+  // һδɼʱɸĿ¼ݵĿ¼
+  void finish(Task* task);
+
+  // Ŀ¼зǿĿ¼inodešԽĿ¼ϹӺ
+  std::vector<i32> list_directory(i32 inode_idx);
+
+  void fail(i32 inode_idx, const std::string& msg);
+
+  // catchм¼׳쳣ٴµĿ¼
+  void raise();
+
+ protected:
+  Disk& disk_;
+  const DiskInodeTravesalMixin& mixin_;
+  u32 threads_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Ѵδִϵʱ
+  std::atomic<i64> outstanding_{0};
+  // еȴִе
+  std::atomic<i64> queued_{0};
+  std::mutex idle_lock_;
+  std::condition_variable idle_cond_;
+
+  std::atomic<bool> failed_{false};
+  // ׳쳣ٴµĿ¼
+  std::atomic<bool> aborted_{false};
+  // ׳ĵһ쳣ڵ߳׳
+  std::exception_ptr error_;
+  std::mutex error_lock_;
+};
+
+}  // namespace v6pp
+
+#endif
\ No newline at end of file
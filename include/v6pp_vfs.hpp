@@ -13,6 +13,8 @@
 #define V6PP_VFS_HPP_
 
 #include <functional>
+#include <string>
+#include <unordered_map>
 
 #include "v6pp_disk.hpp"
 #include "vfs.hpp"
@@ -38,6 +40,8 @@ class FileSystemConfig {
   std::string rootfs_path = "../etc/rootfs";
   // ļߴǷʽ̡
   bool format_on_disksize_validation_failure_ = true;
+  // ̶дˡ
+  DiskConfig disk_config_;
   // ûӡ
   std::function<std::string(const std::string&)> asker_ = [](...) {
     return "";
@@ -62,12 +66,19 @@ class FileSystem : public FileSystemBase {
 
  protected:
   std::vector<i32> _pwalk(const std::string& path, bool to_directory);
+  // Ŀ¼вƣҲʱ-1Ŀ¼档
+  i32 _lookup(i32 dir_idx, const std::string& name);
   Inode& _touch(const std::string& path, FileType ftype);
   void _rmfile(const std::string& path, FileType ftype);
+  // Թ̶СĴڰsrcݸƵdst
+  void _copy(Inode& src, Inode& dst);
 
  protected:
   Disk* disk_;
   std::vector<i32> inode_idx_stack_;
+  // Ŀ¼棺Ŀ¼inode ->  -> inode-1ʾƲڡ
+  // Ŀ¼޸Ķ_touch()_rmfile()߸ά档
+  std::unordered_map<i32, std::unordered_map<std::string, i32>> dentries_;
   const FileSystemConfig& config_;
 };
 
@@ -18,6 +18,9 @@
 
 using namespace v6pp;
 
+// в蹲õĴ̲
+static DiskConfig __disk_config;
+
 void prepare_diskfile(const std::string& path) {
   std::ofstream ftest(path, std::ios::out | std::ios::binary);
   if (!ftest.is_open())
@@ -32,7 +35,7 @@ void write_binaries(const std::string& image_path,
                     const std::string& bootloader_path,
                     const std::string& kernel_path) {
   try {
-    v6pp::Disk disk(image_path);
+    v6pp::Disk disk(image_path, __disk_config);
 
     disk.write_bootloader(bootloader_path);
     disk.write_kernel(kernel_path);
@@ -45,6 +48,7 @@ void format_diskfile(const std::string& image_path) {
   try {
     v6pp::FileSystemConfig config;
     config.disk_path_ = image_path;
+    config.disk_config_ = __disk_config;
     config.asker_ = [&](const std::string&) { return "y"; };
     config.speaker_ = [&](const std::string& m) {
       std::cout << "format: " << m << std::endl;
@@ -63,6 +67,7 @@ void write_rootfs(const std::string& image_path, std::string rootfs_path) {
   try {
     v6pp::FileSystemConfig config;
     config.disk_path_ = image_path;
+    config.disk_config_ = __disk_config;
     config.speaker_ = [&](const std::string& m) {
       std::cout << "write_rootfs: " << m << std::endl;
     };
@@ -115,6 +120,8 @@ int main(int argc, char** argv) {
     rule.add_rule("kernel", aptype_is_str | apshow_strict);
     rule.add_rule("boot", aptype_is_str | apshow_strict);
     rule.add_rule("rootfs", aptype_is_str | apshow_strict);
+    rule.add_rule("io", aptype_is_str | apshow_once);
+    rule.add_rule("delayalloc", aptype_is_uint | apshow_once);
 
     if (rule.accept(argc, argv, &cli_params)) {
       std::cout << "Error: " << rule.error() << std::endl;
@@ -125,6 +132,16 @@ int main(int argc, char** argv) {
       boot_path = cli_params["boot"];
       rootfs_path = cli_params["rootfs"];
     }
+
+    if (cli_params.count("io") &&
+        !__disk_config.set_backend(cli_params["io"])) {
+      std::cout << "Error: unknown io backend: " << cli_params["io"]
+                << std::endl;
+      return -1;
+    }
+    if (cli_params.count("delayalloc")) {
+      __disk_config.delay_alloc_bytes_ = std::stoul(cli_params["delayalloc"]);
+    }
   }
 
   // ļʹָС
@@ -91,11 +91,15 @@ void cli(v6pp::FileSystem& fs) {
 
 int main(int argc, char** argv) {
   std::string image_path;
+  v6pp::FileSystemConfig config;
 
   if (1) {
     std::map<std::string, std::string> result;
     ArgParseRule rule;
     rule.add_rule("image", aptype_is_str | apshow_strict);
+    rule.add_rule("io", aptype_is_str | apshow_once);
+    rule.add_rule("readahead", aptype_is_uint | apshow_once);
+    rule.add_rule("delayalloc", aptype_is_uint | apshow_once);
 
     if (rule.accept(argc, argv, &result)) {
       std::cerr << "Error: " << rule.error() << std::endl;
@@ -103,9 +107,18 @@ int main(int argc, char** argv) {
     }
 
     image_path = result["image"];
+    if (result.count("io") && !config.disk_config_.set_backend(result["io"])) {
+      std::cerr << "Error: unknown io backend: " << result["io"] << std::endl;
+      return -1;
+    }
+    if (result.count("readahead")) {
+      config.disk_config_.readahead_blocks_ = std::stoul(result["readahead"]);
+    }
+    if (result.count("delayalloc")) {
+      config.disk_config_.delay_alloc_bytes_ = std::stoul(result["delayalloc"]);
+    }
   }
 
-  v6pp::FileSystemConfig config;
   config.asker_ = [&](const std::string& prompt) {
     std::cout << prompt;
     std::string line;
@@ -0,0 +1,91 @@
+/**
+ * @file v6pp_block_bitmap.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 19:20:03
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+
+#include "v6pp_block_bitmap.hpp"
+
+using namespace v6pp;
+
+static constexpr i32 WORD_BITS = 64;
+
+BlockBitmap::BlockBitmap(u32 block_cnt)
+    : block_cnt_(block_cnt), words_((block_cnt + WORD_BITS - 1) / WORD_BITS) {}
+
+bool BlockBitmap::is_free(i32 block_idx) const {
+  return (words_[block_idx / WORD_BITS] >> (block_idx % WORD_BITS)) & 1u;
+}
+
+bool BlockBitmap::mark_free(i32 block_idx) {
+  u64 mask = u64(1) << (block_idx % WORD_BITS);
+  u64& word = words_[block_idx / WORD_BITS];
+  if (word & mask) return false;
+  word |= mask;
+  ++free_cnt_;
+  return true;
+}
+
+bool BlockBitmap::mark_used(i32 block_idx) {
+  u64 mask = u64(1) << (block_idx % WORD_BITS);
+  u64& word = words_[block_idx / WORD_BITS];
+  if (!(word & mask)) return false;
+  word &= ~mask;
+  --free_cnt_;
+  return true;
+}
+
+void BlockBitmap::clear() {
+  std::fill(words_.begin(), words_.end(), 0);
+  free_cnt_ = 0;
+}
+
+i32 BlockBitmap::find_free(i32 from, i32 to) const {
+  to = std::min(to, i32(block_cnt_));
+  while (from < to) {
+    // εfrom֮ǰλ
+    u64 word = words_[from / WORD_BITS] & (~u64(0) << (from % WORD_BITS));
+    if (word) {
+      i32 ret = from / WORD_BITS * WORD_BITS + __builtin_ctzll(word);
+      return ret < to ? ret : -1;
+    }
+    from = (from / WORD_BITS + 1) * WORD_BITS;
+  }
+  return -1;
+}
+
+i32 BlockBitmap::find_used(i32 from, i32 to) const {
+  to = std::min(to, i32(block_cnt_));
+  while (from < to) {
+    u64 word = ~words_[from / WORD_BITS] & (~u64(0) << (from % WORD_BITS));
+    if (word) {
+      i32 ret = from / WORD_BITS * WORD_BITS + __builtin_ctzll(word);
+      return std::min(ret, to);
+    }
+    from = (from / WORD_BITS + 1) * WORD_BITS;
+  }
+  return to;
+}
+
+i32 BlockBitmap::find_run(i32 len, i32 from, i32 to) const {
+  to = std::min(to, i32(block_cnt_));
+  while (from < to) {
+    i32 head = find_free(from, to);
+    if (head < 0) return -1;
+    i32 tail = find_used(head, std::min(to, head + len));
+    if (tail - head >= len) return head;
+    from = tail;
+  }
+  return -1;
+}
+
+u32 BlockBitmap::free_count() const { return free_cnt_; }
+
+u32 BlockBitmap::size() const { return block_cnt_; }
\ No newline at end of file
@@ -0,0 +1,187 @@
+/**
+ * @file v6pp_block_cache.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 17:15:30
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "v6pp_block_cache.hpp"
+
+using namespace v6pp;
+
+// ղ۵Ŀš
+static constexpr i32 NO_BLOCK = -1;
+
+BlockCache::BlockCache(u32 capacity)
+    : capacity_(capacity > 0 ? capacity : 1),
+      entries_(capacity_, Entry{NO_BLOCK, false, false}),
+      data_(size_t(capacity_) * DiskProps::BLOCK_SIZE) {}
+
+char* BlockCache::slot_data(u32 slot) {
+  return data_.data() + size_t(slot) * DiskProps::BLOCK_SIZE;
+}
+
+bool BlockCache::lookup(i32 block_idx, char* dest) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = slots_.find(block_idx);
+  if (it == slots_.end()) {
+    ++misses_;
+    return false;
+  }
+
+  ++hits_;
+  entries_[it->second].referenced_ = true;
+  memcpy(dest, slot_data(it->second), DiskProps::BLOCK_SIZE);
+  return true;
+}
+
+bool BlockCache::insert(i32 block_idx, const char* src, bool dirty) {
+  std::lock_guard<std::mutex> lock(lock_);
+  return insert_locked(block_idx, src, dirty);
+}
+
+bool BlockCache::insert_locked(i32 block_idx, const char* src, bool dirty) {
+  u32 slot;
+  bool ok = true;
+
+  auto it = slots_.find(block_idx);
+  if (it != slots_.end()) {
+    slot = it->second;
+    // ǸɾݲĨԭеǡ
+    dirty |= entries_[slot].dirty_;
+  } else {
+    ok = evict(slot);
+    entries_[slot] = Entry{block_idx, false, false};
+    slots_[block_idx] = slot;
+  }
+
+  entries_[slot].dirty_ = dirty;
+  memcpy(slot_data(slot), src, DiskProps::BLOCK_SIZE);
+  return ok;
+}
+
+/**
+ * @brief
+ *
+ * ̺ͷ붼ɣ̵߳д뻥
+ * дڻУᱻǣдݻḲԤĿ顣
+ */
+bool BlockCache::fill(i32 block_idx, i32 block_cnt, const Reader& reader) {
+  std::lock_guard<std::mutex> lock(lock_);
+  i32 first = 0, last = block_cnt - 1;
+  while (first <= last && slots_.count(block_idx + first)) ++first;
+  while (last >= first && slots_.count(block_idx + last)) --last;
+  if (first > last) return true;
+
+  // ǰѻĿ飬ϵǾɵġʱ
+  // ǿܱûȥҪȼ£ºٲ顣
+  std::vector<bool> cached(last - first + 1);
+  for (i32 idx = first; idx <= last; ++idx)
+    cached[idx - first] = slots_.count(block_idx + idx) > 0;
+
+  std::vector<char> buf(size_t(last - first + 1) * DiskProps::BLOCK_SIZE);
+  if (!reader(block_idx + first, last - first + 1, buf.data())) return false;
+
+  bool ok = true;
+  for (i32 idx = first; idx <= last; ++idx) {
+    if (cached[idx - first] || slots_.count(block_idx + idx)) continue;
+    const char* pblk = buf.data() + size_t(idx - first) * DiskProps::BLOCK_SIZE;
+    ok &= insert_locked(block_idx + idx, pblk, false);
+  }
+  return ok;
+}
+
+void BlockCache::refresh(i32 block_idx, const char* src) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = slots_.find(block_idx);
+  if (it != slots_.end()) {
+    entries_[it->second].dirty_ = false;
+    memcpy(slot_data(it->second), src, DiskProps::BLOCK_SIZE);
+  }
+}
+
+void BlockCache::invalidate(i32 block_idx) {
+  std::lock_guard<std::mutex> lock(lock_);
+  auto it = slots_.find(block_idx);
+  if (it != slots_.end()) {
+    entries_[it->second] = Entry{NO_BLOCK, false, false};
+    slots_.erase(it);
+  }
+}
+
+void BlockCache::clear() {
+  std::lock_guard<std::mutex> lock(lock_);
+  entries_.assign(capacity_, Entry{NO_BLOCK, false, false});
+  slots_.clear();
+  hand_ = 0;
+}
+
+/**
+ * @brief
+ *
+ * תCLOCKָ룺ʱǵĿ飬ûһǵĿ顣
+ * ûĿ飬дء
+ *
+ * @param slot ѡеĲۺš
+ * @return дʧʱfalseʱÿ޸Ķʧ
+ */
+bool BlockCache::evict(u32& slot) {
+  while (true) {
+    Entry& entry = entries_[hand_];
+    u32 cur = hand_;
+    hand_ = (hand_ + 1) % capacity_;
+
+    if (entry.block_idx_ == NO_BLOCK) {
+      slot = cur;
+      return true;
+    }
+    if (entry.referenced_) {
+      entry.referenced_ = false;
+      continue;
+    }
+
+    bool ok = true;
+    if (entry.dirty_) {
+      ok = writeback_({{entry.block_idx_, slot_data(cur)}});
+    }
+    slots_.erase(entry.block_idx_);
+    entry = Entry{NO_BLOCK, false, false};
+    slot = cur;
+    return ok;
+  }
+}
+
+bool BlockCache::flush() {
+  std::lock_guard<std::mutex> lock(lock_);
+  std::vector<BlockRef> dirty;
+  for (u32 slot = 0; slot < capacity_; ++slot) {
+    if (entries_[slot].block_idx_ != NO_BLOCK && entries_[slot].dirty_)
+      dirty.push_back({entries_[slot].block_idx_, slot_data(slot)});
+  }
+  if (dirty.empty()) return true;
+
+  std::sort(dirty.begin(), dirty.end());
+  if (!writeback_(dirty)) return false;
+
+  for (auto& entry : entries_) entry.dirty_ = false;
+  return true;
+}
+
+u32 BlockCache::capacity() const { return capacity_; }
+
+u64 BlockCache::hits() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return hits_;
+}
+
+u64 BlockCache::misses() const {
+  std::lock_guard<std::mutex> lock(lock_);
+  return misses_;
+}
\ No newline at end of file
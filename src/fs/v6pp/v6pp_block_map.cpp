@@ -0,0 +1,54 @@
+/**
+ * @file v6pp_block_map.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 22:51:43
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+
+#include "v6pp_block_map.hpp"
+
+using namespace v6pp;
+
+void BlockMap::append(i32 logical, i32 physical) {
+  if (!extents_.empty()) {
+    Extent& last = extents_.back();
+    if (last.logical_ + last.length_ == logical &&
+        last.physical_ + last.length_ == physical) {
+      ++last.length_;
+      return;
+    }
+  }
+  extents_.push_back(Extent{logical, physical, 1});
+}
+
+void BlockMap::clear() {
+  extents_.clear();
+  fsize_ = -1;
+}
+
+i32 BlockMap::lookup(i32 logical) const {
+  i32 pos = find(logical);
+  if (pos < 0) return -1;
+  return extents_[pos].physical_ + (logical - extents_[pos].logical_);
+}
+
+i32 BlockMap::find(i32 logical) const {
+  // һlogicalĶεǰһΡ
+  auto it = std::upper_bound(
+      extents_.begin(), extents_.end(), logical,
+      [](i32 value, const Extent& ext) { return value < ext.logical_; });
+  if (it == extents_.begin()) return -1;
+  --it;
+  if (logical >= it->logical_ + it->length_) return -1;
+  return i32(it - extents_.begin());
+}
+
+const std::vector<BlockMap::Extent>& BlockMap::extents() const {
+  return extents_;
+}
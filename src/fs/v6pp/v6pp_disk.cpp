@@ -9,24 +9,86 @@
  *
  */
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <functional>
 
 #include "defines.hpp"
 #include "exceptions.hpp"
+#include "io_direct_file.hpp"
 #include "io_fstream_file.hpp"
+#include "io_mmap_file.hpp"
+#include "io_posix_file.hpp"
+#include "io_ram_file.hpp"
 #include "util_time.hpp"
 #include "v6pp_block.hpp"
 #include "v6pp_disk.hpp"
 #include "v6pp_inode.hpp"
 #include "v6pp_inode_directory.hpp"
 #include "v6pp_superblock.hpp"
+#include "v6pp_tree_walker.hpp"
 
 
 using namespace v6pp;
 using namespace io;
 
+namespace {
+
+// DiskBlockTraversalMixinĸתΪߡ
+class MixinVisitor : public BlockVisitor {
+ public:
+  explicit MixinVisitor(const DiskBlockTraversalMixin& mixin)
+      : mixin_(mixin) {}
+
+  i32 allocate(i32 old_block_idx) {
+    return mixin_.block_allocator_(old_block_idx);
+  }
+
+  void direct_setup(i32 fileoff, i32 block_idx) {
+    mixin_.direct_block_setup_(fileoff, block_idx);
+  }
+  void direct_process(i32 fileoff, i32 block_idx) {
+    mixin_.direct_block_process_(fileoff, block_idx);
+  }
+  void direct_teardown(i32 fileoff, i32 block_idx) {
+    mixin_.direct_block_teardown_(fileoff, block_idx);
+  }
+
+  void indirect_setup(const char* pblk, i32 block_idx) {
+    mixin_.indirect_block_setup_(pblk, block_idx);
+  }
+  void indirect_teardown(const char* pblk, i32 block_idx) {
+    mixin_.indirect_block_teardown_(pblk, block_idx);
+  }
+
+  void failure(Inode& inode, i32 size_remaining, const std::string& msg) {
+    mixin_.failure_handler_(inode, size_remaining, msg);
+  }
+
+  bool read_ahead() const { return mixin_.read_ahead_; }
+
+ protected:
+  const DiskBlockTraversalMixin& mixin_;
+};
+
+}  // namespace
+
+// Ķдƹ棬ݰѻ
+static constexpr i32 CACHE_BYPASS_BLOCKS = 16;
+
+bool DiskConfig::set_backend(const std::string& name) {
+  static const char* names[FileBackend::MAX] = {"fstream", "mmap", "posix",
+                                                "direct", "ram"};
+  for (i32 idx = 0; idx < FileBackend::MAX; ++idx) {
+    if (name == names[idx]) {
+      backend_ = FileBackend(idx);
+      return true;
+    }
+  }
+  return false;
+}
+
 /**
  * @brief
  *
@@ -34,9 +96,39 @@ using namespace io;
  * ע⣺Ҫͨloadֶش̡
  *
  * @param filepath
+ * @param config ָд˵Ȳ
  */
-Disk::Disk(const std::string& filepath) {
-  file_ = new FstreamFile(filepath);
+Disk::Disk(const std::string& filepath, const DiskConfig& config)
+    : config_(config),
+      engine_(nullptr),
+      cache_(nullptr),
+      readahead_(nullptr),
+      index_cache_(nullptr),
+      pool_(DiskProps::BLOCK_SIZE * io_depth()),
+      free_map_(DiskProps::get_disk_blocks()),
+      inode_map_(sizeof(inodes_) / sizeof(Inode)) {
+  // δload()Ĵ̶еȱʡݣȫΪ޸ġ
+  inode_dirty_.assign(DiskProps::BLOCKS_INODE_ZONE, true);
+  superblock_.s_fmod_ = 1;
+  build_inode_map();
+
+  switch (config.backend_) {
+    case DiskConfig::MMAP:
+      file_ = new MmapFile(filepath);
+      break;
+    case DiskConfig::POSIX:
+      file_ = new PosixFile(filepath);
+      break;
+    case DiskConfig::DIRECT:
+      file_ = new DirectFile(filepath);
+      break;
+    case DiskConfig::RAM:
+      file_ = new RamFile(filepath);
+      break;
+    default:
+      file_ = new FstreamFile(filepath);
+      break;
+  }
   // Уļߴ硣
   file_->seekg(0, FileBase::FILE_END);
   u32 fsize = file_->tellg();
@@ -51,6 +143,26 @@ Disk::Disk(const std::string& filepath) {
     ex.set_kv("expected_size", DiskProps::get_disk_size());
     throw ex;
   }
+
+  engine_ = IoEngine::create(*file_, config_.io_depth_);
+
+  if (config_.cache_blocks_ > 0) {
+    cache_ = new BlockCache(config_.cache_blocks_);
+    cache_->writeback_ = [this](const std::vector<BlockCache::BlockRef>& b) {
+      return write_back_blocks(b);
+    };
+  }
+
+  if (config_.index_cache_blocks_ > 0)
+    index_cache_ = new BlockCache(config_.index_cache_blocks_);
+
+  if (cache_ && config_.readahead_blocks_ > 0) {
+    readahead_ = new ReadAhead(*cache_, config_.readahead_blocks_);
+    readahead_->reader_ = [this](i32 block_idx, i32 block_cnt, char* dest) {
+      return file_->read_at(i64(block_idx) * DiskProps::BLOCK_SIZE, dest,
+                            block_cnt * DiskProps::BLOCK_SIZE);
+    };
+  }
 }
 
 /**
@@ -61,7 +173,15 @@ Disk::Disk(const std::string& filepath) {
  */
 Disk::~Disk() {
   if (file_) {
+    delete readahead_;
+    readahead_ = nullptr;
     update();
+    delete cache_;
+    cache_ = nullptr;
+    delete index_cache_;
+    index_cache_ = nullptr;
+    delete engine_;
+    engine_ = nullptr;
     delete file_;
     file_ = nullptr;
   }
@@ -82,18 +202,25 @@ void Disk::load() {
   u32 inode_off = superblock_.p_off_inodes_ * DiskProps::BLOCK_SIZE;
   u32 inode_size = superblock_.p_size_inodes_ * DiskProps::BLOCK_SIZE;
 
-  file_->seekg(inode_off, FileBase::FILE_SET);
-  file_->read((char*)inodes_, inode_size);
-  if (!file_->good()) {
-    throw FileSystemException(file_->error());
-  }
-  if (file_->tellg() != inode_off + inode_size) {
+  if (!file_->read_at(inode_off, (char*)inodes_, inode_size)) {
     auto ex = FileSystemException("Disk::load: broken inode area");
-    ex.set_kv("actual_bytes", file_->tellg() - inode_off);
+    ex.set_kv("reason", file_->error());
     ex.set_kv("expected_bytes", inode_size);
     throw ex;
   }
 
+  // նһ¡ϵs_fmod_û壬һ
+  superblock_.s_fmod_ = 0;
+  inode_dirty_.assign(inode_dirty_.size(), false);
+  // ̿λͼؽ
+  free_map_loaded_ = false;
+  build_inode_map();
+  delayed_.clear();
+  delayed_bytes_ = 0;
+  delayed_blocks_ = 0;
+  block_maps_.clear();
+  if (index_cache_) index_cache_->clear();
+
   // ԭ߽VFSʹ߼ۺϳһFileSystemAdapter
   // ǷֿƵģԳʼû·һŵVFSʵ֡
 }
@@ -108,37 +235,118 @@ void Disk::load() {
  * - ͷеinode
  * - еĿ̿ӵ̿
  * - øļinode
- * - һЩҪļ
+ *
+ * 顢inodeͿ̿λͼڴһɣȫΪ޸ģ
+ * update()дأinodeһд룬̿滺水˳д롣
+ * ñҪļVFSɡ
  *
  * ʽںˣҲ᳹Ĩݡ
  */
 void Disk::format() {
-  // Ѿv6pp::FileSystem::format()ʵ֡
+  if (readahead_) readahead_->drain();
+
+  superblock_.format();
+  mark_superblock_dirty();
+  delayed_.clear();
+  delayed_bytes_ = 0;
+  delayed_blocks_ = 0;
+  block_maps_.clear();
+  if (index_cache_) index_cache_->clear();
+
+  // ͷеinodeǰ100inode
+  for (Inode& inode : inodes_) inode.format();
+  inode_dirty_.assign(inode_dirty_.size(), true);
+  build_inode_map();
+  for (i32 idx = inode_map_.find_free(IDX_ROOT_INODE + 1, inode_map_.size());
+       idx >= 0 && superblock_.s_ninode_ < 100;
+       idx = inode_map_.find_free(idx + 1, inode_map_.size())) {
+    superblock_.s_inode_[superblock_.s_ninode_++] = idx;
+  }
+
+  // ȫСݲдأstore_free_map()ɡ
+  free_map_.clear();
+  for (u32 idx = superblock_.p_off_data_;
+       idx < superblock_.p_off_data_ + superblock_.p_size_data_; ++idx) {
+    if (cache_) cache_->invalidate(idx);
+    free_map_.mark_free(idx);
+  }
+  alloc_cursor_ = superblock_.p_off_data_;
+  free_map_loaded_ = true;
+  free_map_dirty_ = true;
+
+  Inode& root = inodes_[IDX_ROOT_INODE];
+  i32 tstamp = Time::stamp();
+  root.prot_owner_ = root.prot_group_ = root.prot_others_ = 7;
+  root.d_nlink_ = 1;
+  root.file_type_ = FileType::DIR;
+  root.d_size_ = 0;
+  root.d_mtime_ = tstamp;
+  root.d_atime_ = tstamp;
+  root.is_gid_ = root.is_uid_ = 0;
+  root.d_gid_ = root.d_uid_ = 0;
+  root.ialloc_ = 1;
 }
 
 /**
  * @brief
  *
- * inodeдش̡
+ * 顢inodeдش̡
+ * inodeֻдر޸ĹĲ֡
  */
 void Disk::update() {
-  // д̡
-  if (!superblock_.update(*file_)) {
-    throw FileSystemException("Disk::update: superblock update failed");
+  // ȴеԤ֤дʱļٱʡ
+  if (readahead_) readahead_->drain();
+
+  // ӳٷļ֮ǰд롣
+  flush_delayed();
+
+  // ̿д볬̿飬滺һдء
+  store_free_map();
+
+  // 鰴˳дء
+  if (cache_ && !cache_->flush()) {
+    auto ex = FileSystemException("Disk::update: block cache flush failed");
+    ex.set_kv("reason", file_->error());
+    throw ex;
   }
 
-  // inodeд̡
-  u32 inode_off = superblock_.p_off_inodes_ * DiskProps::BLOCK_SIZE;
-  u32 inode_size = superblock_.p_size_inodes_ * DiskProps::BLOCK_SIZE;
-  file_->seekp(inode_off, FileBase::FILE_SET);
-  file_->write((char*)inodes_, inode_size);
-  if (!file_->good()) {
-    throw FileSystemException(file_->error());
-  }
-  if (file_->tellp() != inode_off + inode_size) {
-    auto ex = FileSystemException("Disk::update: broken inode area");
-    ex.set_kv("actual_bytes", file_->tellp() - inode_off);
-    ex.set_kv("expected_bytes", inode_size);
+  // д̡дĸs_fmod_Ϊ0
+  if (superblock_.s_fmod_) {
+    superblock_.s_fmod_ = 0;
+    if (!superblock_.update(*file_)) {
+      superblock_.s_fmod_ = 1;
+      throw FileSystemException("Disk::update: superblock update failed");
+    }
+  }
+
+  // inodeд̣ڵ޸̿ϲд롣
+  i32 inode_blocks = std::min<i32>(superblock_.p_size_inodes_,
+                                   inode_dirty_.size());
+  for (i32 head = 0, tail; head < inode_blocks; head = tail) {
+    if (!inode_dirty_[head]) {
+      tail = head + 1;
+      continue;
+    }
+    for (tail = head; tail < inode_blocks && inode_dirty_[tail]; ++tail) {
+      inode_dirty_[tail] = false;
+    }
+
+    u32 inode_off = (superblock_.p_off_inodes_ + head) * DiskProps::BLOCK_SIZE;
+    u32 inode_size = (tail - head) * DiskProps::BLOCK_SIZE;
+    const char* src = (const char*)inodes_ + head * DiskProps::BLOCK_SIZE;
+    if (!file_->write_at(inode_off, src, inode_size)) {
+      for (i32 idx = head; idx < tail; ++idx) inode_dirty_[idx] = true;
+      auto ex = FileSystemException("Disk::update: broken inode area");
+      ex.set_kv("reason", file_->error());
+      ex.set_kv("expected_bytes", inode_size);
+      throw ex;
+    }
+  }
+
+  // ڴеĴļڴдء
+  if (!file_->flush()) {
+    auto ex = FileSystemException("Disk::update: flush failed");
+    ex.set_kv("reason", file_->error());
     throw ex;
   }
 }
@@ -190,25 +398,42 @@ bool Disk::read_block(Block& block, i32 block_idx) {
 }
 
 bool Disk::read_blocks(char* dest, i32 block_idx, i32 block_cnt) {
-  bool arg_check = true;
-  // 顣
-  arg_check &= (dest != nullptr);
-  arg_check &= (block_cnt > 0);
-  arg_check &= (block_idx >= 0);
-  arg_check &= (block_idx + block_cnt <= DiskProps::get_disk_blocks());
+  check_block_args("Disk::read_blocks", dest, block_idx, block_cnt);
 
-  if (!arg_check) {
-    auto ex = FileSystemException("Disk::read_blocks: invalid arguments");
-    ex.set_kv("dest", u64(dest));
-    ex.set_kv("block_idx", block_idx);
-    ex.set_kv("block_cnt", block_cnt);
-    throw ex;
+  // ִж
+  if (!cache_) {
+    return file_->read_at(i64(block_idx) * DiskProps::BLOCK_SIZE, dest,
+                          block_cnt * DiskProps::BLOCK_SIZE)
+               ? true
+               : (file_->error(), false);
   }
 
-  // ִж
-  file_->seekg(block_idx * DiskProps::BLOCK_SIZE, FileBase::FILE_SET);
-  file_->read(dest, block_cnt * DiskProps::BLOCK_SIZE);
-  return (file_->good()) ? true : (file_->error(), false);
+  // еĿӻ渴ƣδпһζ롣
+  for (i32 head = 0, tail; head < block_cnt; head = tail) {
+    char* pblk = dest + head * DiskProps::BLOCK_SIZE;
+    if (cache_->lookup(block_idx + head, pblk)) {
+      tail = head + 1;
+      continue;
+    }
+    for (tail = head + 1; tail < block_cnt; ++tail) {
+      char* ptail = dest + tail * DiskProps::BLOCK_SIZE;
+      if (cache_->lookup(block_idx + tail, ptail)) break;
+    }
+
+    if (!file_->read_at(i64(block_idx + head) * DiskProps::BLOCK_SIZE, pblk,
+                        (tail - head) * DiskProps::BLOCK_SIZE)) {
+      file_->error();
+      return false;
+    }
+    if (block_cnt <= CACHE_BYPASS_BLOCKS) {
+      for (i32 idx = head; idx < tail; ++idx)
+        cache_->insert(block_idx + idx, dest + idx * DiskProps::BLOCK_SIZE,
+                       false);
+    }
+    // ѭһеĿѾϡ
+    if (tail < block_cnt) ++tail;
+  }
+  return true;
 }
 
 bool Disk::write_block(const Block& block, i32 block_idx) {
@@ -216,38 +441,594 @@ bool Disk::write_block(const Block& block, i32 block_idx) {
 }
 
 bool Disk::write_blocks(const char* src, i32 block_idx, i32 block_cnt) {
+  check_block_args("Disk::write_blocks", src, block_idx, block_cnt);
+
+  // ֻд뻺棬update()дء
+  if (cache_ && block_cnt <= CACHE_BYPASS_BLOCKS) {
+    bool ok = true;
+    for (i32 idx = 0; idx < block_cnt; ++idx)
+      ok &= cache_->insert(block_idx + idx, src + idx * DiskProps::BLOCK_SIZE,
+                           true);
+    return ok;
+  }
+
+  // ִд
+  if (!file_->write_at(i64(block_idx) * DiskProps::BLOCK_SIZE, src,
+                       block_cnt * DiskProps::BLOCK_SIZE)) {
+    file_->error();
+    return false;
+  }
+  if (cache_) {
+    for (i32 idx = 0; idx < block_cnt; ++idx)
+      cache_->refresh(block_idx + idx, src + idx * DiskProps::BLOCK_SIZE);
+  }
+  return true;
+}
+
+void Disk::queue_read_blocks(char* dest, i32 block_idx, i32 block_cnt) {
+  check_block_args("Disk::queue_read_blocks", dest, block_idx, block_cnt);
+  pending_reads_.push_back({block_idx, block_cnt, dest});
+}
+
+void Disk::queue_write_blocks(const char* src, i32 block_idx, i32 block_cnt) {
+  check_block_args("Disk::queue_write_blocks", src, block_idx, block_cnt);
+  pending_writes_.push_back({block_idx, block_cnt, (char*)src});
+}
+
+bool Disk::submit_blocks() {
+  std::vector<PendingBlocks> reads, writes;
+  if (cache_) {
+    sync_pending_with_cache();
+    reads = pending_reads_;
+    writes = pending_writes_;
+  }
+
+  merge_pending(pending_writes_, true);
+  merge_pending(pending_reads_, false);
+  if (!engine_->submit()) {
+    file_->error();
+    return false;
+  }
+
+  if (cache_) fill_cache_from_pending(reads, writes);
+  return true;
+}
+
+/**
+ * @brief
+ *
+ * Ŷӵдͬʱ뻺棨Ϊɾ飩֤воݣ
+ * ŶӵĶѻĿֱӸƣֻδеĲֽ档
+ * дڶmerge_pendingύ˳һ¡
+ */
+void Disk::sync_pending_with_cache() {
+  for (auto& req : pending_writes_) {
+    for (i32 idx = 0; idx < req.block_cnt_; ++idx) {
+      const char* pblk = req.buf_ + idx * DiskProps::BLOCK_SIZE;
+      if (req.block_cnt_ <= CACHE_BYPASS_BLOCKS)
+        cache_->insert(req.block_idx_ + idx, pblk, false);
+      else
+        cache_->refresh(req.block_idx_ + idx, pblk);
+    }
+  }
+
+  std::vector<PendingBlocks> misses;
+  for (auto& req : pending_reads_) {
+    for (i32 head = 0, tail; head < req.block_cnt_; head = tail) {
+      char* pblk = req.buf_ + head * DiskProps::BLOCK_SIZE;
+      if (cache_->lookup(req.block_idx_ + head, pblk)) {
+        tail = head + 1;
+        continue;
+      }
+      for (tail = head + 1; tail < req.block_cnt_; ++tail) {
+        char* ptail = req.buf_ + tail * DiskProps::BLOCK_SIZE;
+        if (cache_->lookup(req.block_idx_ + tail, ptail)) break;
+      }
+      misses.push_back({req.block_idx_ + head, tail - head, pblk});
+      if (tail < req.block_cnt_) ++tail;
+    }
+  }
+  pending_reads_.swap(misses);
+}
+
+/**
+ * @brief
+ *
+ * ѶĿ뻺档дĿˢһ飺дڼ䣬
+ * Ԥ߳̿ѰѴϵľݶ档
+ */
+void Disk::fill_cache_from_pending(const std::vector<PendingBlocks>& reads,
+                                   const std::vector<PendingBlocks>& writes) {
+  for (auto& req : writes) {
+    for (i32 idx = 0; idx < req.block_cnt_; ++idx)
+      cache_->refresh(req.block_idx_ + idx,
+                      req.buf_ + idx * DiskProps::BLOCK_SIZE);
+  }
+  for (auto& req : reads) {
+    if (req.block_cnt_ > CACHE_BYPASS_BLOCKS) continue;
+    for (i32 idx = 0; idx < req.block_cnt_; ++idx)
+      cache_->insert(req.block_idx_ + idx,
+                     req.buf_ + idx * DiskProps::BLOCK_SIZE, false);
+  }
+}
+
+/**
+ * @brief
+ *
+ * дعӣڵĿϲΪһηɢд롣
+ * ʱ洦ڼ״̬ܻص棻Ԥ߳ûʱҲã
+ * Բ档
+ */
+bool Disk::write_back_blocks(const std::vector<BlockCache::BlockRef>& blocks) {
+  std::vector<io::IoSlice> slices;
+  for (size_t head = 0, tail; head < blocks.size(); head = tail) {
+    i32 next = blocks[head].first;
+    slices.clear();
+    for (tail = head; tail < blocks.size() && blocks[tail].first == next;
+         ++tail, ++next) {
+      slices.push_back({(char*)blocks[tail].second, DiskProps::BLOCK_SIZE});
+    }
+
+    i64 offset = i64(blocks[head].first) * DiskProps::BLOCK_SIZE;
+    if (!file_->writev_at(offset, slices.data(), slices.size())) return false;
+  }
+  return true;
+}
+
+void Disk::discard_blocks() {
+  pending_reads_.clear();
+  pending_writes_.clear();
+  engine_->discard();
+}
+
+/**
+ * @brief
+ *
+ * 󣬰ѿڵϲһηɢ/ۼд
+ * ڴҲڵĶٺϲһΡ
+ * ļʱݿ飬ֻһpread
+ */
+void Disk::merge_pending(std::vector<PendingBlocks>& pending, bool write) {
+  // Ķޣڸƽ̨IOV_MAX
+  static const size_t MAX_SLICES = 256;
+
+  std::stable_sort(pending.begin(), pending.end(),
+                   [](const PendingBlocks& a, const PendingBlocks& b) {
+                     return a.block_idx_ < b.block_idx_;
+                   });
+
+  std::vector<io::IoSlice> slices;
+  for (size_t head = 0, tail; head < pending.size(); head = tail) {
+    i32 run_end = pending[head].block_idx_;
+    slices.clear();
+
+    for (tail = head; tail < pending.size() && slices.size() < MAX_SLICES &&
+                      pending[tail].block_idx_ == run_end;
+         ++tail) {
+      char* addr = pending[tail].buf_;
+      size_t size = pending[tail].block_cnt_ * DiskProps::BLOCK_SIZE;
+      if (!slices.empty() &&
+          slices.back().addr_ + slices.back().size_ == addr) {
+        slices.back().size_ += size;
+      } else {
+        slices.push_back({addr, size});
+      }
+      run_end += pending[tail].block_cnt_;
+    }
+
+    i64 offset = i64(pending[head].block_idx_) * DiskProps::BLOCK_SIZE;
+    if (write)
+      engine_->queue_writev(offset, slices.data(), slices.size());
+    else
+      engine_->queue_readv(offset, slices.data(), slices.size());
+  }
+  pending.clear();
+}
+
+bool Disk::read_blocks_v(const std::vector<BlockBuffer>& blocks) {
+  for (auto& blk : blocks) queue_read_blocks(blk.second, blk.first, 1);
+  return submit_blocks();
+}
+
+bool Disk::write_blocks_v(const std::vector<ConstBlockBuffer>& blocks) {
+  for (auto& blk : blocks) queue_write_blocks(blk.second, blk.first, 1);
+  return submit_blocks();
+}
+
+i32 Disk::io_depth() const {
+  return config_.io_depth_ > 0 ? config_.io_depth_ : 1;
+}
+
+void Disk::check_block_args(const char* caller, const void* buf, i32 block_idx,
+                            i32 block_cnt) {
   bool arg_check = true;
-  // 
-  arg_check &= (src != nullptr);
-  arg_check &= (block_idx >= 0);
+  // 顣
+  arg_check &= (buf != nullptr);
   arg_check &= (block_cnt > 0);
+  arg_check &= (block_idx >= 0);
   arg_check &= (block_idx + block_cnt <= DiskProps::get_disk_blocks());
 
   if (!arg_check) {
-    auto ex = FileSystemException("Disk::write_blocks: invalid arguments");
-    ex.set_kv("src", u64(src));
+    auto ex = FileSystemException(std::string(caller) + ": invalid arguments");
+    ex.set_kv("buf", u64(buf));
     ex.set_kv("block_idx", block_idx);
     ex.set_kv("block_cnt", block_cnt);
     throw ex;
   }
-
-  // ִд
-  file_->seekp(block_idx * DiskProps::BLOCK_SIZE, FileBase::FILE_SET);
-  file_->write(src, block_cnt * DiskProps::BLOCK_SIZE);
-  return (file_->good()) ? true : (file_->error(), false);
 }
 
 bool Disk::read_file(char* dest, Inode& inode) {
-  DiskBlockTraversalMixin mixin;
+  auto it = delayed_.find(inode_index(inode));
+  if (it != delayed_.end()) {
+    memcpy(dest, it->second.data(), it->second.size());
+    return true;
+  }
 
-  mixin.direct_block_process_ = [&](i32 file_offset, i32 blk_idx) {
-    read_blocks(dest + file_offset, blk_idx, 1);
-  };
-  mixin.failure_handler_ = [](Inode&, i32, const std::string& errmsg) {
-    throw FileSystemException(errmsg);
-  };
+  // ÿ̿һζ룬ÿһύһΡ
+  i32 queued = 0;
+  for (auto& ext : block_map(inode).extents()) {
+    if (queued == io_depth()) {
+      if (!submit_blocks()) return false;
+      queued = 0;
+    }
+    queue_read_blocks(dest + i64(ext.logical_) * DiskProps::BLOCK_SIZE,
+                      ext.physical_, ext.length_);
+    ++queued;
+  }
+  return submit_blocks();
+}
+
+/**
+ * @brief
+ *
+ * ȡļĿӳ䣬ûлѾʱһؽ
+ */
+const BlockMap& Disk::block_map(Inode& inode) {
+  i32 inode_idx = inode_index(inode);
+  BlockMap& map = inode_idx >= 0 ? block_maps_[inode_idx] : scratch_map_;
+  if (inode_idx >= 0 && map.fsize_ == i32(inode.d_size_)) return map;
+
+  struct Mapper : BlockVisitor {
+    BlockMap& map_;
+
+    explicit Mapper(BlockMap& map) : map_(map) {}
+
+    void direct_process(i32 file_offset, i32 blk_idx) {
+      map_.append(file_offset / DiskProps::BLOCK_SIZE, blk_idx);
+    }
+    void failure(Inode&, i32, const std::string& errmsg) {
+      map_.clear();
+      throw FileSystemException(errmsg);
+    }
+  } mapper(map);
 
-  return traverse_blocks_over_inode(inode, mixin);
+  map.clear();
+  traverse_blocks(inode, mapper);
+  map.fsize_ = inode.d_size_;
+  return map;
+}
+
+void Disk::invalidate_block_map(const Inode& inode) {
+  i32 inode_idx = inode_index(inode);
+  if (inode_idx >= 0) block_maps_.erase(inode_idx);
+}
+
+i32 Disk::read_at(Inode& inode, i32 offset, i32 len, char* buf) {
+  if (offset < 0 || len < 0) {
+    auto ex = FileSystemException("Disk::read_at: invalid range");
+    ex.set_kv("offset", offset);
+    ex.set_kv("len", len);
+    throw ex;
+  }
+  len = std::max(0, std::min<i32>(len, i32(inode.d_size_) - offset));
+  if (len == 0) return 0;
+
+  auto it = delayed_.find(inode_index(inode));
+  if (it != delayed_.end()) {
+    memcpy(buf, it->second.data() + offset, len);
+    return len;
+  }
+
+  transfer_at(inode, offset, len, buf, false);
+  return len;
+}
+
+i32 Disk::write_at(Inode& inode, i32 offset, i32 len, const char* buf) {
+  if (offset < 0 || len < 0 || i64(offset) + len > i64(inode.d_size_)) {
+    auto ex = FileSystemException("Disk::write_at: invalid range");
+    ex.set_kv("offset", offset);
+    ex.set_kv("len", len);
+    ex.set_kv("fsize", inode.d_size_);
+    throw ex;
+  }
+  if (len == 0) return 0;
+
+  auto it = delayed_.find(inode_index(inode));
+  if (it != delayed_.end()) {
+    memcpy(it->second.data() + offset, buf, len);
+    return len;
+  }
+
+  transfer_at(inode, offset, len, (char*)buf, true);
+  return len;
+}
+
+void Disk::write_block_at(Inode& inode, i32 block, const char* buf) {
+  const i32 BS = DiskProps::BLOCK_SIZE;
+  if (block < 0 || i64(block) * BS >= i64(inode.d_size_)) {
+    auto ex = FileSystemException("Disk::write_block_at: invalid block");
+    ex.set_kv("block", block);
+    ex.set_kv("fsize", inode.d_size_);
+    throw ex;
+  }
+
+  auto it = delayed_.find(inode_index(inode));
+  if (it != delayed_.end()) {
+    i32 len = std::min<i32>(BS, i32(inode.d_size_) - block * BS);
+    memcpy(it->second.data() + block * BS, buf, len);
+    return;
+  }
+
+  i32 blk_idx = block_map(inode).lookup(block);
+  if (blk_idx < 0) {
+    auto ex = FileSystemException("Disk::write_block_at: unmapped block");
+    ex.set_kv("block", block);
+    throw ex;
+  }
+  if (!write_blocks(buf, blk_idx, 1)) {
+    auto ex = FileSystemException("Disk::write_block_at: I/O failed");
+    ex.set_kv("block", blk_idx);
+    ex.set_kv("reason", file_->error());
+    throw ex;
+  }
+}
+
+void Disk::reserve_file(Inode& inode, i32 fsize) {
+  if (fsize > FSIZE_MAX) {
+    throw FileSystemException(
+        "Disk::reserve_file: maximum file size exceeded.");
+  }
+  free_inode_blocks(inode);
+
+  std::vector<i32> reserved;
+  if (!alloc_blocks(blocks_for_size(fsize), reserved)) {
+    throw FileSystemException("Disk::reserve_file: out of free blocks.");
+  }
+  if (!write_file_blocks(nullptr, inode, fsize, reserved.data())) {
+    auto ex = FileSystemException("Disk::reserve_file: index writing failed");
+    ex.set_kv("reason", file_->error());
+    throw ex;
+  }
+}
+
+/**
+ * @brief
+ *
+ * ԭе̿鱣ֲ䣬ʱλð˳ȡԤ̿顣
+ * λǷ֮ǰݿжϣµĵһݿ֮ǰ䡣
+ */
+void Disk::append(Inode& inode, const char* src, i32 len) {
+  if (len < 0) {
+    auto ex = FileSystemException("Disk::append: invalid length");
+    ex.set_kv("len", len);
+    throw ex;
+  }
+  if (len == 0) return;
+  i32 old_size = inode.d_size_;
+  if (i64(old_size) + len > FSIZE_MAX) {
+    throw FileSystemException("Disk::append: maximum file size exceeded.");
+  }
+  i32 new_size = old_size + len;
+  i32 need = blocks_for_size(new_size) - blocks_for_size(old_size);
+
+  // ڻеļֱڴ׷ӣŲʱд̡
+  i32 inode_idx = inode_index(inode);
+  auto it = delayed_.find(inode_idx);
+  if (it != delayed_.end()) {
+    load_free_map();
+    if (delayed_bytes_ + len <= config_.delay_alloc_bytes_ &&
+        u32(delayed_blocks_ + need) <= free_map_.free_count()) {
+      it->second.insert(it->second.end(), src, src + len);
+      delayed_bytes_ += len;
+      delayed_blocks_ += need;
+      inode.d_size_ = new_size;
+      inode.ilarg_ = !!(new_size > sizeof(Block) * 6);
+      mark_inode_dirty(inode_idx);
+      return;
+    }
+    flush_delayed(inode);
+  }
+
+  // ԭһĿƴһд롣
+  const i32 BS = DiskProps::BLOCK_SIZE;
+  i32 first = old_size / BS;
+  i32 head = old_size - first * BS;
+  std::vector<char> tail(size_t(new_size - first * BS + BS - 1) / BS * BS);
+  if (head > 0) read_at(inode, first * BS, head, tail.data());
+  memcpy(tail.data() + head, src, len);
+
+  std::vector<i32> reserved;
+  if (!alloc_blocks(need, reserved)) {
+    throw FileSystemException("Disk::append: out of free blocks.");
+  }
+  inode.d_size_ = new_size;
+  inode.ilarg_ = !!(new_size > sizeof(Block) * 6);
+  mark_inode_dirty(inode);
+
+  struct Appender : BlockVisitor {
+    Disk& disk_;
+    const char* tail_;
+    i32 first_;
+    i32 old_cnt_;
+    const std::vector<i32>& reserved_;
+    i32 next_reserved_ = 0;
+    i32 next_block_ = 0;
+    // ǰݡ
+    std::vector<Block> saved_;
+
+    Appender(Disk& disk, const char* tail, i32 first, i32 old_cnt,
+             const std::vector<i32>& reserved)
+        : disk_(disk), tail_(tail), first_(first), old_cnt_(old_cnt),
+          reserved_(reserved) {}
+
+    i32 allocate(i32 old_blk_idx) {
+      if (next_block_ < old_cnt_) return old_blk_idx;
+      return next_reserved_ < i32(reserved_.size())
+                 ? reserved_[next_reserved_++]
+                 : -1;
+    }
+    void direct_process(i32 file_offset, i32 blk_idx) {
+      if (next_block_++ < first_) return;
+      disk_.queue_write_blocks(
+          tail_ + file_offset - first_ * DiskProps::BLOCK_SIZE, blk_idx, 1);
+    }
+    void indirect_setup(const char* pblk, i32) {
+      saved_.emplace_back();
+      memcpy(saved_.back().data(), pblk, sizeof(Block));
+    }
+    // ֻдиĶ̿顣
+    void indirect_teardown(const char* pblk, i32 blk_idx) {
+      if (memcmp(saved_.back().data(), pblk, sizeof(Block)) != 0)
+        disk_.write_blocks(pblk, blk_idx, 1);
+      saved_.pop_back();
+    }
+    void failure(Inode&, i32, const std::string& errmsg) {
+      disk_.discard_blocks();
+      throw FileSystemException(errmsg);
+    }
+  } appender(*this, tail.data(), first, (old_size + BS - 1) / BS, reserved);
+
+  traverse_blocks(inode, appender);
+  if (!submit_blocks()) {
+    auto ex = FileSystemException("Disk::append: block writing failed");
+    ex.set_kv("reason", file_->error());
+    throw ex;
+  }
+}
+
+/**
+ * @brief
+ *
+ * µĵһݿѳ´Сʱͷš
+ * г´Сıٱʣظд
+ */
+void Disk::truncate(Inode& inode, i32 new_size) {
+  i32 old_size = inode.d_size_;
+  if (new_size < 0) {
+    auto ex = FileSystemException("Disk::truncate: invalid size");
+    ex.set_kv("new_size", new_size);
+    throw ex;
+  }
+  if (new_size >= old_size) {
+    std::vector<char> zeros(new_size - old_size);
+    append(inode, zeros.data(), new_size - old_size);
+    return;
+  }
+  if (new_size == 0) {
+    free_inode_blocks(inode);
+    return;
+  }
+
+  i32 inode_idx = inode_index(inode);
+  auto it = delayed_.find(inode_idx);
+  if (it != delayed_.end()) {
+    it->second.resize(new_size);
+    delayed_bytes_ -= old_size - new_size;
+    delayed_blocks_ -= blocks_for_size(old_size) - blocks_for_size(new_size);
+  } else {
+    struct Truncator : BlockVisitor {
+      i32 new_cnt_;
+      i32 next_block_ = 0;
+      std::vector<bool> dropped_;
+      std::vector<i32> blocks_;
+
+      explicit Truncator(i32 new_cnt) : new_cnt_(new_cnt) {}
+
+      void direct_process(i32, i32 blk_idx) {
+        if (next_block_++ >= new_cnt_) blocks_.push_back(blk_idx);
+      }
+      void indirect_setup(const char*, i32) {
+        dropped_.push_back(next_block_ >= new_cnt_);
+      }
+      void indirect_teardown(const char*, i32 blk_idx) {
+        if (dropped_.back()) blocks_.push_back(blk_idx);
+        dropped_.pop_back();
+      }
+    } truncator((new_size + DiskProps::BLOCK_SIZE - 1) /
+                DiskProps::BLOCK_SIZE);
+    traverse_blocks(inode, truncator);
+
+    // inodeָͷ̿㡣
+    auto& blocks = truncator.blocks_;
+    for (i32 idx = 0; idx < 10; ++idx) {
+      u32& slot = *(inode.idx_direct_ + idx);
+      if (std::find(blocks.begin(), blocks.end(), i32(slot)) != blocks.end())
+        slot = 0;
+    }
+    free_blocks(truncator.blocks_);
+    invalidate_block_map(inode);
+  }
+
+  inode.d_size_ = new_size;
+  inode.ilarg_ = !!(new_size > sizeof(Block) * 6);
+  mark_inode_dirty(inode);
+}
+
+/**
+ * @brief
+ *
+ * ӳζдļݡΧɵ߼顣
+ */
+void Disk::transfer_at(Inode& inode, i32 offset, i32 len, char* buf,
+                       bool write) {
+  const i32 BS = DiskProps::BLOCK_SIZE;
+  const BlockMap& map = block_map(inode);
+  const char* what = write ? "Disk::write_at" : "Disk::read_at";
+
+  for (i32 done = 0; done < len;) {
+    i32 pos = offset + done;
+    i32 ext_idx = map.find(pos / BS);
+    if (ext_idx < 0) {
+      auto ex = FileSystemException(std::string(what) + ": unmapped block");
+      ex.set_kv("block", pos / BS);
+      throw ex;
+    }
+    const BlockMap::Extent& ext = map.extents()[ext_idx];
+    i32 blk_idx = ext.physical_ + (pos / BS - ext.logical_);
+    i32 run = ext.logical_ + ext.length_ - pos / BS;
+
+    bool ok = true;
+    i32 step, blocks = 1;
+    if (pos % BS != 0 || len - done < BS) {
+      // Ŀ顣
+      Block b;
+      step = std::min(BS - pos % BS, len - done);
+      ok = read_block(b, blk_idx);
+      if (ok && write) {
+        memcpy(b.data() + pos % BS, buf + done, step);
+        ok = write_block(b, blk_idx);
+      } else if (ok) {
+        memcpy(buf + done, b.data() + pos % BS, step);
+      }
+    } else {
+      // ͬһڵһζд
+      blocks = std::min(run, (len - done) / BS);
+      step = blocks * BS;
+      ok = write ? write_blocks(buf + done, blk_idx, blocks)
+                 : read_blocks(buf + done, blk_idx, blocks);
+    }
+    if (!ok) {
+      auto ex = FileSystemException(std::string(what) + ": I/O failed");
+      ex.set_kv("block", blk_idx);
+      ex.set_kv("reason", file_->error());
+      throw ex;
+    }
+    // ˳ȡʱԤѺ̿ǰ뻺档
+    if (!write && readahead_) {
+      for (i32 idx = 0; idx < blocks; ++idx) readahead_->observe(blk_idx + idx);
+    }
+    done += step;
+  }
 }
 
 bool Disk::write_file(const char* src, Inode& inode, i32 fsize) {
@@ -259,55 +1040,284 @@ bool Disk::write_file(const char* src, Inode& inode, i32 fsize) {
   // дļǰҪļԭݡ
   free_inode_blocks(inode);
 
+  // ӳٷ䣺ֻݣҪ֤ʱ㹻̿顣
+  i32 inode_idx = inode_index(inode);
+  u32 limit = config_.delay_alloc_bytes_;
+  if (inode_idx >= 0 && fsize > 0 && u32(fsize) <= limit) {
+    if (delayed_bytes_ + fsize > limit) flush_delayed();
+    load_free_map();
+    i32 need = blocks_for_size(fsize);
+    if (u32(delayed_blocks_ + need) > free_map_.free_count()) {
+      throw FileSystemException("Disk::write_file: out of free blocks.");
+    }
+    delayed_[inode_idx].assign(src, src + fsize);
+    delayed_bytes_ += fsize;
+    delayed_blocks_ += need;
+
+    inode.d_size_ = fsize;
+    inode.ilarg_ = !!(fsize > sizeof(Block) * 6);
+    inode.prot_owner_ = inode.prot_group_ = inode.prot_others_ = 7;
+    mark_inode_dirty(inode_idx);
+    return true;
+  }
+
+  // ΪҪдļҪ̿顣
+  // ݿһϣʱ˳ȡá
+  std::vector<i32> reserved;
+  if (!alloc_blocks(blocks_for_size(fsize), reserved)) {
+    throw FileSystemException("Disk::write_file: out of free blocks.");
+  }
+  return write_file_blocks(src, inode, fsize, reserved.data());
+}
+
+bool Disk::write_file_blocks(const char* src, Inode& inode, i32 fsize,
+                             const i32* reserved) {
   i32 size_remaining = fsize;
   inode.d_size_ = size_remaining;
   inode.ilarg_ = !!(size_remaining > sizeof(Block) * 6);
   // ΪV6++ĿǰûûȨĿǰν
   inode.prot_owner_ = inode.prot_group_ = inode.prot_others_ = 7;
+  mark_inode_dirty(inode);
 
-  DiskBlockTraversalMixin mixin;
-  // ΪҪдļҪ̿顣
-  mixin.block_allocator_ = [&](i32 old_blk_idx) { return alloc_block(); };
-  mixin.direct_block_process_ = [&](i32 file_offset, i32 blk_idx) {
-    write_blocks(src + file_offset, blk_idx, 1);
-  };
-  // ĬǲдؼģҪֶдء
-  mixin.indirect_block_teardown_ = [&](const char* pblk, i32 blk_idx) {
-    write_blocks(pblk, blk_idx, 1);
-  };
-  mixin.failure_handler_ = [&](Inode&, i32, const std::string& errmsg) {
-    throw FileSystemException(errmsg);
-  };
+  struct Writer : BlockVisitor {
+    Disk& disk_;
+    const char* src_;
+    const i32* reserved_;
+    i32 reserved_cnt_;
+    i32 next_reserved_ = 0;
+
+    Writer(Disk& disk, const char* src, const i32* reserved, i32 reserved_cnt)
+        : disk_(disk), src_(src), reserved_(reserved),
+          reserved_cnt_(reserved_cnt) {}
 
-  return traverse_blocks_over_inode(inode, mixin);
+    i32 allocate(i32) {
+      return next_reserved_ < reserved_cnt_ ? reserved_[next_reserved_++] : -1;
+    }
+    void direct_process(i32 file_offset, i32 blk_idx) {
+      if (src_) disk_.queue_write_blocks(src_ + file_offset, blk_idx, 1);
+    }
+    // ĬǲдؼģҪֶдء
+    void indirect_teardown(const char* pblk, i32 blk_idx) {
+      disk_.write_blocks(pblk, blk_idx, 1);
+    }
+    void failure(Inode&, i32, const std::string& errmsg) {
+      disk_.discard_blocks();
+      throw FileSystemException(errmsg);
+    }
+  } writer(*this, src, reserved, blocks_for_size(fsize));
+
+  traverse_blocks(inode, writer);
+  return submit_blocks();
+}
+
+/**
+ * @brief
+ *
+ * Ϊлļһη̿鲢д롣
+ * inodeȡã̿㹻ʱļβӡ
+ */
+void Disk::flush_delayed() {
+  if (delayed_.empty()) return;
+
+  // Ԥ̿һη䣬ļдɹƳ塣
+  i32 unwritten = delayed_blocks_;
+  delayed_blocks_ = 0;
+  std::vector<i32> reserved;
+  if (!alloc_blocks(unwritten, reserved)) {
+    delayed_blocks_ = unwritten;
+    throw FileSystemException("Disk::flush_delayed: out of free blocks.");
+  }
+
+  size_t pos = 0;
+  while (!delayed_.empty()) {
+    // дǰƳ壬ļ̿ʱٴд롣
+    auto it = delayed_.begin();
+    i32 inode_idx = it->first;
+    std::vector<char> data = std::move(it->second);
+    delayed_.erase(it);
+    try {
+      write_delayed(inode_idx, data, reserved.data() + pos);
+    } catch (FileSystemException&) {
+      // δдļڻУ黹ΪǷ̿顣
+      delayed_[inode_idx] = std::move(data);
+      delayed_blocks_ = unwritten;
+      free_blocks(std::vector<i32>(reserved.begin() + pos, reserved.end()));
+      throw;
+    }
+    i32 need = blocks_for_size(data.size());
+    delayed_bytes_ -= data.size();
+    unwritten -= need;
+    pos += need;
+  }
+}
+
+void Disk::flush_delayed(Inode& inode) {
+  i32 inode_idx = inode_index(inode);
+  auto it = delayed_.find(inode_idx);
+  if (it == delayed_.end()) return;
+
+  std::vector<char> data = std::move(it->second);
+  i32 fsize = data.size();
+  i32 need = blocks_for_size(fsize);
+  delayed_.erase(it);
+  delayed_bytes_ -= fsize;
+  delayed_blocks_ -= need;
+
+  std::vector<i32> reserved;
+  try {
+    if (!alloc_blocks(need, reserved)) {
+      throw FileSystemException("Disk::flush_delayed: out of free blocks.");
+    }
+    write_delayed(inode_idx, data, reserved.data());
+  } catch (FileSystemException&) {
+    // дʧܵļŻػ壬黹Ϊ̿顣
+    free_blocks(reserved);
+    delayed_[inode_idx] = std::move(data);
+    delayed_bytes_ += fsize;
+    delayed_blocks_ += need;
+    throw;
+  }
+}
+
+void Disk::write_delayed(i32 inode_idx, const std::vector<char>& data,
+                         const i32* reserved) {
+  Inode& inode = inodes_[inode_idx];
+  i32 fsize = data.size();
+  try {
+    if (!write_file_blocks(data.data(), inode, fsize, reserved)) {
+      auto ex = FileSystemException("Disk::flush_delayed: write failed");
+      ex.set_kv("inode_idx", inode_idx);
+      ex.set_kv("reason", file_->error());
+      throw ex;
+    }
+  } catch (FileSystemException&) {
+    // еļû̿飬Ѿ
+    inode.d_size_ = fsize;
+    for (i32 idx = 0; idx < 10; ++idx) *(inode.idx_direct_ + idx) = 0;
+    invalidate_block_map(inode);
+    mark_inode_dirty(inode);
+    throw;
+  }
+}
+
+bool Disk::drop_delayed(i32 inode_idx) {
+  auto it = delayed_.find(inode_idx);
+  if (it == delayed_.end()) return false;
+  delayed_bytes_ -= it->second.size();
+  delayed_blocks_ -= blocks_for_size(it->second.size());
+  delayed_.erase(it);
+  return true;
 }
 
+void Disk::reserve_for_delayed(i32 block_cnt) {
+  if (delayed_blocks_ > 0 &&
+      u32(block_cnt + delayed_blocks_) > free_map_.free_count())
+    flush_delayed();
+}
+
+/**
+ * @brief
+ *
+ * һ̿顣
+ *
+ * ϴηλҵһп飬ĩβƻؿͷ
+ * ķõ̿ġ
+ *
+ * @return ̿ţ̿þʱ-1
+ */
 i32 Disk::alloc_block() {
-  i32 ret = -1;
-  if (superblock_.s_nfree_ == 0) {
-    // һ̿Ѿþ
-    ret = -1;
-  } else if (superblock_.s_nfree_ >= 2) {
-    // ζǰ̿鲻̿顣
-    ret = superblock_.s_free_[--superblock_.s_nfree_];
-  } else {
-    // ǰ̿̿顣
-    ret = superblock_.s_free_[0];
-    Block b;
-    // һӦùܶȡ0
-    if (ret != 0)
-      read_block(b, ret);
-    else
-      ret = -1;
-    // Ϊ̿洢s_nfrees_free
-    // ʹmemcpyһԸǡ
-    memcpy(&superblock_.s_nfree_, b.data(), 101 * sizeof(u32));
+  load_free_map();
+  reserve_for_delayed(1);
+  i32 ret = free_map_.find_free(alloc_cursor_, free_map_.size());
+  if (ret < 0) ret = free_map_.find_free(0, alloc_cursor_);
+  if (ret < 0) return -1;
+
+  free_map_.mark_used(ret);
+  alloc_cursor_ = ret + 1;
+  free_map_dirty_ = true;
+  mark_superblock_dirty();
+  return ret;
+}
+
+/**
+ * @brief
+ *
+ * block_cntĿ̿顣
+ *
+ * @return ʼ̿ţҲ㹻жʱ-1
+ */
+i32 Disk::alloc_extent(i32 block_cnt) {
+  load_free_map();
+  if (block_cnt <= 0) return -1;
+  reserve_for_delayed(block_cnt);
+  i32 ret = free_map_.find_run(block_cnt, alloc_cursor_, free_map_.size());
+  if (ret < 0) ret = free_map_.find_run(block_cnt, 0, alloc_cursor_);
+  if (ret < 0) return -1;
+
+  for (i32 idx = ret; idx < ret + block_cnt; ++idx) free_map_.mark_used(idx);
+  alloc_cursor_ = ret + block_cnt;
+  free_map_dirty_ = true;
+  mark_superblock_dirty();
+  return ret;
+}
+
+/**
+ * @brief
+ *
+ * һηblock_cnt̿飬ʹ
+ * Ҳ㹻жʱ˳ϴηλȡ
+ * ̿鲻ʱκ̿飬false
+ *
+ * @param block_cnt
+ * @param out 䵽̿ţ׷ĩβ
+ */
+bool Disk::alloc_blocks(i32 block_cnt, std::vector<i32>& out) {
+  load_free_map();
+  if (block_cnt <= 0) return true;
+  reserve_for_delayed(block_cnt);
+  if (u32(block_cnt) > free_map_.free_count()) return false;
+
+  i32 start = alloc_extent(block_cnt);
+  if (start >= 0) {
+    for (i32 idx = 0; idx < block_cnt; ++idx) out.push_back(start + idx);
+    return true;
   }
 
-  if (ret >= i32(DiskProps::get_disk_blocks())) {
-    auto ex = FileSystemException("Disk::alloc_block: invalid block index");
-    ex.set_kv("ret", ret);
-    throw ex;
+  // ɶƴɡ
+  for (i32 idx = 0; idx < block_cnt; ++idx) out.push_back(alloc_block());
+  return true;
+}
+
+void Disk::free_blocks(const std::vector<i32>& blocks) {
+  for (i32 idx : blocks) free_block(idx);
+}
+
+/**
+ * @brief
+ *
+ * fsizeֽڵļ̿ݿ͸顣
+ */
+i32 Disk::blocks_for_size(i32 fsize) {
+  static const i32 ENTRIES_PER_BLOCK = sizeof(Block) / sizeof(u32);
+  static const i32 IDXS_DIRECT = 6;
+  static const i32 IDXS_L1 = 2;
+
+  auto blocks_for = [](i32 entries, i32 per_block) {
+    return (entries + per_block - 1) / per_block;
+  };
+  i32 ret = blocks_for(fsize, DiskProps::BLOCK_SIZE);
+  i32 remaining = ret - IDXS_DIRECT;
+  if (remaining <= 0) return ret;
+
+  // һ顣
+  i32 under_l1 = std::min(remaining, IDXS_L1 * ENTRIES_PER_BLOCK);
+  ret += blocks_for(under_l1, ENTRIES_PER_BLOCK);
+  remaining -= under_l1;
+
+  // 鼰µһ顣
+  if (remaining > 0) {
+    i32 l1_blocks = blocks_for(remaining, ENTRIES_PER_BLOCK);
+    ret += l1_blocks + blocks_for(l1_blocks, ENTRIES_PER_BLOCK);
   }
   return ret;
 }
@@ -318,28 +1328,131 @@ void Disk::free_block(i32 idx) {
     ex.set_kv("idx", idx);
     throw ex;
   }
+  // ͷŵĿ壬дء
+  if (cache_) cache_->invalidate(idx);
+  if (index_cache_) index_cache_->invalidate(idx);
+
+  load_free_map();
+  free_map_.mark_free(idx);
+  free_map_dirty_ = true;
+  mark_superblock_dirty();
+}
 
-  // ǰ޿̿顣
-  if (superblock_.s_nfree_ == 0) {
-    superblock_.s_free_[0] = 0;
-    superblock_.s_nfree_ = 1;
-  }
+/**
+ * @brief
+ *
+ * سеĿ̿̿飬̿λͼ
+ * ֻڵһηͷ̿ʱУֻĻỰȡ̿顣
+ */
+void Disk::load_free_map() {
+  if (free_map_loaded_) return;
+
+  free_map_.clear();
+  alloc_cursor_ = superblock_.p_off_data_;
+
+  u32 nfree = superblock_.s_nfree_;
+  u32 free_list[100];
+  memcpy(free_list, superblock_.s_free_, sizeof(free_list));
+  for (i32 chained = 0;; ++chained) {
+    if (nfree > 100 || chained > i32(DiskProps::get_disk_blocks())) {
+      auto ex = FileSystemException("Disk::load_free_map: broken free list");
+      ex.set_kv("nfree", nfree);
+      ex.set_kv("chained", chained);
+      throw ex;
+    }
+    for (u32 idx = 0; idx < nfree; ++idx) {
+      // 0ſβǡ
+      if (free_list[idx] == 0) continue;
+      if (free_list[idx] >= DiskProps::get_disk_blocks()) {
+        auto ex = FileSystemException("Disk::load_free_map: invalid block");
+        ex.set_kv("block_idx", free_list[idx]);
+        throw ex;
+      }
+      free_map_.mark_free(free_list[idx]);
+    }
+    // ֻʣ̿ʱһڸ̿С
+    if (nfree == 0 || free_list[0] == 0) break;
 
-  if (superblock_.s_nfree_ < 100) {
-    // һǰ̿δ
-    superblock_.s_free_[superblock_.s_nfree_++] = idx;
-  } else {
-    // ζǰ̿
-    // ǰд̿飬̿Ϊ̿顣
     Block b;
-    memcpy(b.data(), &superblock_.s_nfree_, 101 * sizeof(u32));
-    write_block(b, idx);
+    if (!read_block(b, free_list[0]))
+      throw FileSystemException("Disk::load_free_map: cannot read free list");
+    memcpy(&nfree, b.data(), sizeof(u32));
+    memcpy(free_list, b.data() + sizeof(u32), sizeof(free_list));
+  }
 
-    superblock_.s_nfree_ = 1;
-    superblock_.s_free_[0] = idx;
+  free_map_loaded_ = true;
+  free_map_dirty_ = false;
+}
+
+/**
+ * @brief
+ *
+ * ɿ̿λͼV6++ʽĿ̸ִ̿ʽݡ
+ *
+ * ɵŴСջеıȱȡã
+ * ȡպȡľһűڵ̿顣
+ */
+void Disk::store_free_map() {
+  if (!free_map_loaded_ || !free_map_dirty_) return;
+
+  std::vector<u32> blocks;
+  blocks.reserve(free_map_.free_count());
+  for (i32 idx = free_map_.find_free(0, free_map_.size()); idx >= 0;
+       idx = free_map_.find_free(idx + 1, free_map_.size())) {
+    blocks.push_back(idx);
+  }
+
+  // ɸһŷ볬飬дԵ̿顣
+  size_t pos = 0;
+  i32 table_block = -1;
+  do {
+    u32 table[101] = {0};
+    size_t cnt = std::min<size_t>(99, blocks.size() - pos);
+    table[0] = cnt + 1;
+    for (size_t idx = 1; idx <= cnt; ++idx) {
+      table[idx + 1] = blocks[pos + cnt - idx];
+    }
+    pos += cnt;
+    // ʣʱһпΪһű̿顣
+    i32 next_block = (pos < blocks.size()) ? blocks[pos++] : 0;
+    table[1] = next_block;
+
+    if (table_block < 0) {
+      memcpy(&superblock_.s_nfree_, table, sizeof(table));
+    } else {
+      Block b;
+      memcpy(b.data(), table, sizeof(table));
+      write_block(b, table_block);
+    }
+    table_block = next_block;
+  } while (table_block != 0);
+
+  superblock_.p_free_blocks_ = blocks.size();
+  superblock_.p_free_check_ = superblock_.free_list_checksum();
+  free_map_dirty_ = false;
+  mark_superblock_dirty();
+}
+
+u32 Disk::total_block_count() const { return superblock_.p_size_data_; }
+
+u32 Disk::free_block_count() {
+  // ¼ȻЧʱΪͳƶ̿λͼ
+  if (!free_map_loaded_ &&
+      superblock_.p_free_check_ == superblock_.free_list_checksum()) {
+    return superblock_.p_free_blocks_ - delayed_blocks_;
   }
+  load_free_map();
+  // ӳٷļѾԤ̿顣
+  return free_map_.free_count() - delayed_blocks_;
+}
+
+u32 Disk::total_inode_count() const {
+  // 0inodeʹá
+  return inode_map_.size() - IDX_ROOT_INODE;
 }
 
+u32 Disk::free_inode_count() const { return inode_map_.free_count(); }
+
 /**
  * @brief
  *
@@ -349,230 +1462,227 @@ void Disk::free_block(i32 idx) {
  */
 i32 Disk::alloc_inode() {
   auto find_free_inodes = [&]() {
-    // Inodeн㡣
-    for (u32 idx = IDX_ROOT_INODE + 1,
-             idx_end = sizeof(inodes_) / sizeof(Inode) - 1;
-         idx <= idx_end && superblock_.s_ninode_ < 100; ++idx) {
-      if (inodes_[idx].ialloc_ == 0) {
-        superblock_.s_inode_[superblock_.s_ninode_++] = idx;
-      }
+    // ɿinodeλͼѷ
+    i32 idx_end = inode_map_.size();
+    for (i32 idx = inode_map_.find_free(IDX_ROOT_INODE + 1, idx_end);
+         idx >= 0 && superblock_.s_ninode_ < 100;
+         idx = inode_map_.find_free(idx + 1, idx_end)) {
+      superblock_.s_inode_[superblock_.s_ninode_++] = idx;
     }
   };
 
-  if (superblock_.s_ninode_ == 0) {
-    find_free_inodes();
-  }
-
-  if (superblock_.s_ninode_ > 0) {
-    // ȡһinode
-    i32 res = superblock_.s_inode_[--superblock_.s_ninode_];
-
-    /**
-     * @brief
-     *
-     * 777Ȩ޺ͷʱ䡣
-     */
-    inodes_[res].ialloc_ = 1;
-    inodes_[res].prot_owner_ = 7;
-    inodes_[res].prot_group_ = 7;
-    inodes_[res].prot_others_ = 7;
-    inodes_[res].d_size_ = 0;
-    inodes_[res].d_nlink_ = 1;
-    inodes_[res].is_gid_ = 0;
-    inodes_[res].is_uid_ = 0;
-    inodes_[res].d_uid_ = 0;
-    inodes_[res].d_gid_ = 0;
-
-    i32 tstamp = Time::stamp();
-    inodes_[res].d_atime_ = tstamp;
-    inodes_[res].d_mtime_ = tstamp;
-
-    // inodeþҪ²ҡ
+  // ܺѷıʽʱĸĿ¼λͼΪ׼
+  i32 res = -1;
+  while (res < 0) {
     if (superblock_.s_ninode_ == 0) {
       find_free_inodes();
+      if (superblock_.s_ninode_ == 0) break;
     }
-
-    return res;
+    i32 idx = superblock_.s_inode_[--superblock_.s_ninode_];
+    if (inode_map_.mark_used(idx)) res = idx;
   }
 
   // ʧܡ
-  return -1;
+  if (res < 0) return -1;
+  mark_superblock_dirty();
+  mark_inode_dirty(res);
+
+  /**
+   * @brief
+   *
+   * 777Ȩ޺ͷʱ䡣
+   */
+  inodes_[res].ialloc_ = 1;
+  inodes_[res].prot_owner_ = 7;
+  inodes_[res].prot_group_ = 7;
+  inodes_[res].prot_others_ = 7;
+  inodes_[res].d_size_ = 0;
+  inodes_[res].d_nlink_ = 1;
+  inodes_[res].is_gid_ = 0;
+  inodes_[res].is_uid_ = 0;
+  inodes_[res].d_uid_ = 0;
+  inodes_[res].d_gid_ = 0;
+
+  i32 tstamp = Time::stamp();
+  inodes_[res].d_atime_ = tstamp;
+  inodes_[res].d_mtime_ = tstamp;
+
+  // inodeþҪ²ҡ
+  if (superblock_.s_ninode_ == 0) {
+    find_free_inodes();
+  }
+
+  return res;
 }
 
 void Disk::free_inode(i32 idx, bool free_blocks) {
   Inode& inode = inodes_[idx];
   if (free_blocks) free_inode_blocks(inode);
 
+  drop_delayed(idx);
+  invalidate_block_map(inode);
   inode.format();
+  mark_inode_dirty(idx);
+  // ʱֻλͼ֮󲹳ʱҵ
+  if (idx > (i32)IDX_ROOT_INODE) inode_map_.mark_free(idx);
   if (superblock_.s_ninode_ < 100) {
     superblock_.s_inode_[superblock_.s_ninode_++] = idx;
+    mark_superblock_dirty();
+  }
+}
+
+void Disk::build_inode_map() {
+  inode_map_.clear();
+  for (u32 idx = IDX_ROOT_INODE + 1; idx < inode_map_.size(); ++idx) {
+    if (inodes_[idx].ialloc_ == 0) inode_map_.mark_free(idx);
   }
 }
 
 void Disk::free_inode_blocks(Inode& inode) {
-  DiskBlockTraversalMixin mixin;
-  mixin.direct_block_teardown_ = [&](i32 file_offset, i32 blk_idx) {
-    free_block(blk_idx);
-  };
-  mixin.indirect_block_teardown_ = [&](const char* pblk, i32 blk_idx) {
-    free_block(blk_idx);
-  };
+  // ռļռõ̿飬һͷš
+  // еļû̿飬ֱӶݡ
+  struct Collector : BlockVisitor {
+    std::vector<i32> blocks_;
+
+    void direct_teardown(i32, i32 blk_idx) { blocks_.push_back(blk_idx); }
+    void indirect_teardown(const char*, i32 blk_idx) {
+      blocks_.push_back(blk_idx);
+    }
+  } collector;
+  if (!drop_delayed(inode_index(inode))) traverse_blocks(inode, collector);
 
-  traverse_blocks_over_inode(inode, mixin);
+  free_blocks(collector.blocks_);
+  invalidate_block_map(inode);
   inode.d_size_ = 0u;
   for (i32 idx = 0; idx < 10; ++idx) *(inode.idx_direct_ + idx) = 0;
+  mark_inode_dirty(inode);
+}
+
+std::vector<i32> Disk::list_inode_blocks(Inode& inode) {
+  // write_file()ȡԤ̿˳򱻵á
+  struct Lister : BlockVisitor {
+    std::vector<i32> blocks_;
+
+    i32 allocate(i32 old_blk_idx) {
+      blocks_.push_back(old_blk_idx);
+      return old_blk_idx;
+    }
+    void failure(Inode&, i32, const std::string& errmsg) {
+      throw FileSystemException(errmsg);
+    }
+  } lister;
+
+  traverse_blocks(inode, lister);
+  return std::move(lister.blocks_);
+}
+
+i32 Disk::count_fragments(Inode& inode) {
+  std::vector<i32> blocks = list_inode_blocks(inode);
+  i32 ret = blocks.empty() ? 0 : 1;
+  for (size_t idx = 1; idx < blocks.size(); ++idx) {
+    if (blocks[idx] != blocks[idx - 1] + 1) ++ret;
+  }
+  return ret;
 }
 
 /**
  * @brief
  *
- * inodeڱݿ顣
- *
- * ATTENTION:
- * mixinĬϲд̿顣
- * Ҫ޸ļmixinд̿顣
+ * ļȫݣдһµ̿飬ͷԭ̿顣
+ * Ҳ㹻жʱκ޸ġ
  */
-bool Disk::traverse_blocks_over_inode(Inode& inode,
-                                      const DiskBlockTraversalMixin& mixin) {
-  // һЩ
-  static const i32 ENTRIES_PER_BLOCK = sizeof(Block) / sizeof(u32);
-  static const i32 IDXS_DIRECT = 6;
-  static const i32 IDXS_L1 = 2;
-  static const i32 IDXS_L2 = 2;
-
-  i32 size_remaining = inode.d_size_;
-  u32 idx_block_l1[ENTRIES_PER_BLOCK];
-  u32 idx_block_l2[ENTRIES_PER_BLOCK];
+bool Disk::defrag_inode(Inode& inode) {
+  i32 fsize = inode.d_size_;
+  if (fsize <= 0 || count_fragments(inode) <= 1) return false;
+
+  i32 block_cnt = blocks_for_size(fsize);
+  i32 start = alloc_extent(block_cnt);
+  if (start < 0) return false;
+  std::vector<i32> reserved(block_cnt);
+  for (i32 idx = 0; idx < block_cnt; ++idx) reserved[idx] = start + idx;
+
+  std::vector<i32> old_blocks = list_inode_blocks(inode);
+  std::vector<char> data((fsize + DiskProps::BLOCK_SIZE - 1) /
+                         DiskProps::BLOCK_SIZE * DiskProps::BLOCK_SIZE);
+  if (!read_file(data.data(), inode)) {
+    free_blocks(reserved);
+    auto ex = FileSystemException("Disk::defrag_inode: read failed");
+    ex.set_kv("reason", file_->error());
+    throw ex;
+  }
 
+  // дʧʱinodeָдһ̿飬ָԭͷ̿顣
+  u32 old_idx[10];
+  for (i32 idx = 0; idx < 10; ++idx) old_idx[idx] = *(inode.idx_direct_ + idx);
   try {
-    /**
-     * @brief
-     *
-     * 6ֱ̿顣
-     */
-    for (i32 idx = 0; size_remaining > 0 && idx < IDXS_DIRECT; ++idx) {
-      // ѡԸֱĬϲ¡
-      i32 new_blk_idx = mixin.block_allocator_(inode.idx_direct_[idx]);
-      if (new_blk_idx < 0)
-        throw FileSystemException(
-            "direct block allocation failed while traversing");
-      inode.idx_direct_[idx] = new_blk_idx;
-      // ݿһֻú
-      mixin.direct_block_setup_(idx * sizeof(Block), inode.idx_direct_[idx]);
-      mixin.direct_block_process_(idx * sizeof(Block), inode.idx_direct_[idx]);
-      mixin.direct_block_teardown_(idx * sizeof(Block), inode.idx_direct_[idx]);
-
-      size_remaining -= sizeof(Block);
-    }
-
-    /**
-     * @brief
-     *
-     * 2һ̿顣
-     */
-    for (i32 idx1 = 0; idx1 < IDXS_L1 && size_remaining > 0; ++idx1) {
-      // ѡԸһĬϲ¡
-      i32 new_blk_idx = mixin.block_allocator_(inode.idx_indirect_[idx1]);
-      if (new_blk_idx < 0)
-        throw FileSystemException(
-            "indirect block allocation failed while traversing");
-      inode.idx_indirect_[idx1] = new_blk_idx;
-
-      // ̿鵽顣
-      read_blocks((char*)idx_block_l1, inode.idx_indirect_[idx1], 1);
-      mixin.indirect_block_setup_((char*)idx_block_l1,
-                                  inode.idx_indirect_[idx1]);
-      // һݿ顣
-      for (i32 idx = 0; idx < ENTRIES_PER_BLOCK && size_remaining > 0; ++idx) {
-        i32 new_blk_idx = mixin.block_allocator_(idx_block_l1[idx]);
-        if (new_blk_idx < 0)
-          throw FileSystemException(
-              "direct block allocation failed while traversing (under indirect "
-              "block)");
-        idx_block_l1[idx] = new_blk_idx;
-
-        u32 blk_offset = DiskProps::BLOCK_SIZE *
-                         (IDXS_DIRECT + ENTRIES_PER_BLOCK * idx1 + idx);
-
-        mixin.direct_block_setup_(blk_offset, idx_block_l1[idx]);
-        mixin.direct_block_process_(blk_offset, idx_block_l1[idx]);
-        mixin.direct_block_teardown_(blk_offset, idx_block_l1[idx]);
-
-        size_remaining -= sizeof(Block);
-      }  // for(idx)
-      mixin.indirect_block_teardown_((char*)idx_block_l1, new_blk_idx);
-    }  // for(idx1)
-
-    /**
-     * @brief
-     *
-     * 2̿顣
-     */
-    for (i32 idx2 = 0; idx2 < IDXS_L2 && size_remaining > 0; ++idx2) {
-      // ѡԸ¶Ĭϲ¡
-      i32 new_blk_idx =
-          mixin.block_allocator_(inode.idx_secondary_indirect_[idx2]);
-      if (new_blk_idx < 0)
-        throw FileSystemException(
-            "secondary indirect block allocation failed while traversing");
-      inode.idx_secondary_indirect_[idx2] = new_blk_idx;
-
-      read_blocks((char*)idx_block_l2, inode.idx_secondary_indirect_[idx2], 1);
-      mixin.indirect_block_setup_((char*)idx_block_l2,
-                                  inode.idx_secondary_indirect_[idx2]);
-
-      // һ
-      for (i32 idx1 = 0; idx1 < ENTRIES_PER_BLOCK && size_remaining > 0;
-           ++idx1) {
-        // ѡԸһĬϲ¡
-        i32 new_blk_idx = mixin.block_allocator_(idx_block_l2[idx1]);
-        if (new_blk_idx < 0)
-          throw FileSystemException(
-              "indirect block allocation failed while traversing (under "
-              "secondary indirect block)");
-        idx_block_l2[idx1] = new_blk_idx;
-
-        read_blocks((char*)idx_block_l1, idx_block_l2[idx1], 1);
-        mixin.indirect_block_setup_((char*)idx_block_l1, idx_block_l2[idx1]);
-
-        // һݿ顣
-        for (i32 idx = 0; size_remaining > 0 && idx < ENTRIES_PER_BLOCK;
-             ++idx) {
-          i32 new_blk_idx = mixin.block_allocator_(idx_block_l1[idx]);
-          if (new_blk_idx < 0)
-            throw FileSystemException(
-                "direct block allocation failed while traversing (under "
-                "secondary indirect block)");
-          idx_block_l1[idx] = new_blk_idx;
-
-          u32 blk_offset = DiskProps::BLOCK_SIZE *
-                           (IDXS_DIRECT + IDXS_L1 * ENTRIES_PER_BLOCK +
-                            idx2 * ENTRIES_PER_BLOCK * ENTRIES_PER_BLOCK +
-                            idx1 * ENTRIES_PER_BLOCK + idx);
-
-          mixin.direct_block_setup_(blk_offset, idx_block_l1[idx]);
-          mixin.direct_block_process_(blk_offset, idx_block_l1[idx]);
-          mixin.direct_block_teardown_(blk_offset, idx_block_l1[idx]);
-
-          size_remaining -= sizeof(Block);
-        }  // for(idx)
-        mixin.indirect_block_teardown_((char*)idx_block_l1, new_blk_idx);
-      }  // for(idx1)
-
-      mixin.indirect_block_teardown_((char*)idx_block_l2, new_blk_idx);
-    }  // for(idx2)
+    if (!write_file_blocks(data.data(), inode, fsize, reserved.data())) {
+      auto ex = FileSystemException("Disk::defrag_inode: write failed");
+      ex.set_kv("reason", file_->error());
+      throw ex;
+    }
+  } catch (FileSystemException&) {
+    inode.d_size_ = fsize;
+    for (i32 idx = 0; idx < 10; ++idx)
+      *(inode.idx_direct_ + idx) = old_idx[idx];
+    invalidate_block_map(inode);
+    mark_inode_dirty(inode);
+    free_blocks(reserved);
+    throw;
+  }
+  free_blocks(old_blocks);
+  return true;
+}
 
-    return true;
-  } catch (FileSystemException& e) {
-    mixin.failure_handler_(inode, size_remaining, e.what());
-    return false;
+void Disk::mark_inode_dirty(i32 inode_idx) {
+  if (inode_idx < 0 || inode_idx >= i32(sizeof(inodes_) / sizeof(Inode))) {
+    auto ex = FileSystemException("Disk::mark_inode_dirty: invalid inode");
+    ex.set_kv("inode_idx", inode_idx);
+    throw ex;
+  }
+  inode_dirty_[inode_idx / INODES_PER_BLOCK] = true;
+}
+
+void Disk::mark_inode_dirty(const Inode& inode) {
+  // inodeеĸ¼
+  i32 inode_idx = inode_index(inode);
+  if (inode_idx >= 0) mark_inode_dirty(inode_idx);
+}
+
+i32 Disk::inode_index(const Inode& inode) const {
+  const Inode* end = inodes_ + sizeof(inodes_) / sizeof(Inode);
+  if (&inode >= inodes_ && &inode < end) return i32(&inode - inodes_);
+  return -1;
+}
+
+void Disk::read_index_block(u32* dest, i32 block_idx) {
+  if (index_cache_ && index_cache_->lookup(block_idx, (char*)dest)) return;
+  if (!read_blocks((char*)dest, block_idx, 1)) {
+    auto ex = FileSystemException("index block reading failed");
+    ex.set_kv("block_idx", block_idx);
+    throw ex;
   }
+  if (index_cache_) index_cache_->insert(block_idx, (const char*)dest, false);
+}
+
+void Disk::store_index_block(const u32* src, i32 block_idx) {
+  if (index_cache_) index_cache_->insert(block_idx, (const char*)src, false);
+}
+
+void Disk::mark_superblock_dirty() { superblock_.s_fmod_ = 1; }
+
+bool Disk::traverse_blocks_over_inode(Inode& inode,
+                                      const DiskBlockTraversalMixin& mixin) {
+  MixinVisitor visitor(mixin);
+  return traverse_blocks(inode, visitor);
 }
 
 bool Disk::traverse_inode_tree(Inode& inode,
                                const DiskInodeTravesalMixin& mixin) {
-  // TODO: not implemented lol.
-  return false;
+  i32 inode_idx = inode_index(inode);
+  if (inode_idx < 0)
+    throw FileSystemException(
+        "Disk::traverse_inode_tree: inode is not in the inode table.");
+  return InodeTreeWalker(*this, mixin).walk(inode_idx);
 }
 
 std::unique_ptr<InodeDirectory> Disk::read_inode_directory(
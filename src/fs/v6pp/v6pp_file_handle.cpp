@@ -0,0 +1,137 @@
+/**
+ * @file v6pp_file_handle.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 23:40:05
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "exceptions.hpp"
+#include "v6pp_file_handle.hpp"
+
+using namespace v6pp;
+
+FileHandle::FileHandle(Disk& disk, Inode& inode)
+    : disk_(disk), inode_(&inode) {}
+
+FileHandle::~FileHandle() {
+  // ʱ׳쳣дʧֻܷ
+  try {
+    close();
+  } catch (FileSystemException&) {
+  }
+}
+
+i32 FileHandle::read(char* buf, i32 len) {
+  check_open("FileHandle::read");
+  len = std::max(0, std::min(len, size() - pos_));
+  if (len == 0) return 0;
+
+  // ȡΧصʱдء
+  const i32 BS = DiskProps::BLOCK_SIZE;
+  if (dirty_hi_ > dirty_lo_ && buffered_ >= pos_ / BS &&
+      buffered_ <= (pos_ + len - 1) / BS)
+    flush();
+
+  i32 ret = disk_.read_at(*inode_, pos_, len, buf);
+  pos_ += ret;
+  return ret;
+}
+
+i32 FileHandle::write(const char* buf, i32 len) {
+  check_open("FileHandle::write");
+  if (len < 0) {
+    auto ex = FileSystemException("FileHandle::write: invalid length");
+    ex.set_kv("len", len);
+    throw ex;
+  }
+
+  // ļĩβڵĲ־͵д룬ಿ׷ӵļĩβ
+  i32 inside = std::min(len, size() - pos_);
+  const i32 BS = DiskProps::BLOCK_SIZE;
+  for (i32 done = 0; done < inside;) {
+    i32 offset = pos_ % BS;
+    if (offset == 0 && inside - done >= BS) {
+      // ֱд롣Уд⸲ݡ
+      i32 whole = (inside - done) / BS * BS;
+      flush();
+      if (buffered_ >= pos_ / BS && buffered_ < (pos_ + whole) / BS)
+        buffered_ = -1;
+      disk_.write_at(*inode_, pos_, whole, buf + done);
+      pos_ += whole;
+      done += whole;
+      continue;
+    }
+
+    // Ŀڻ޸ġ
+    if (buffered_ != pos_ / BS) {
+      flush();
+      buffered_ = pos_ / BS;
+      memset(block_.data(), 0, BS);
+      disk_.read_at(*inode_, buffered_ * BS, BS, block_.data());
+    }
+    i32 step = std::min(BS - offset, inside - done);
+    memcpy(block_.data() + offset, buf + done, step);
+    if (dirty_hi_ == dirty_lo_) {
+      dirty_lo_ = offset;
+      dirty_hi_ = offset + step;
+    } else {
+      dirty_lo_ = std::min(dirty_lo_, offset);
+      dirty_hi_ = std::max(dirty_hi_, offset + step);
+    }
+    pos_ += step;
+    done += step;
+  }
+  if (inside < len) {
+    flush();
+    // ׷ӵݿڻԽԭļĩβĲ֣֮ϡ
+    buffered_ = -1;
+    disk_.append(*inode_, buf + inside, len - inside);
+    pos_ += len - inside;
+  }
+  return len;
+}
+
+i32 FileHandle::seek(i32 offset, Whence whence) {
+  check_open("FileHandle::seek");
+  i64 base = whence == SET ? 0 : whence == CUR ? pos_ : size();
+  i64 pos = base + offset;
+  if (pos < 0 || pos > size()) {
+    auto ex = FileSystemException("FileHandle::seek: invalid position");
+    ex.set_kv("pos", pos);
+    ex.set_kv("fsize", size());
+    throw ex;
+  }
+  pos_ = pos;
+  return pos_;
+}
+
+i32 FileHandle::tell() const { return pos_; }
+
+i32 FileHandle::size() const { return inode_->d_size_; }
+
+Inode& FileHandle::inode() { return *inode_; }
+
+void FileHandle::flush() {
+  if (!inode_ || dirty_hi_ == dirty_lo_) return;
+  // ʱѾ飬޸ĺϲУдؼɡ
+  disk_.write_block_at(*inode_, buffered_, block_.data());
+  dirty_lo_ = dirty_hi_ = 0;
+}
+
+void FileHandle::close() {
+  flush();
+  inode_ = nullptr;
+  buffered_ = -1;
+}
+
+void FileHandle::check_open(const char* caller) const {
+  if (!inode_)
+    throw FileSystemException(std::string(caller) + ": file is closed");
+}
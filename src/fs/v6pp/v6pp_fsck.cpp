@@ -0,0 +1,185 @@
+/**
+ * @file v6pp_fsck.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 21:31:05
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "exceptions.hpp"
+#include "v6pp_fsck.hpp"
+
+using namespace v6pp;
+
+DiskChecker::DiskChecker(Disk& disk, u32 threads)
+    : disk_(disk),
+      threads_(threads),
+      inode_cnt_(sizeof(disk.inodes_) / sizeof(Inode)),
+      block_refs_((DiskProps::get_disk_blocks() + 63) / 64),
+      inode_reached_((inode_cnt_ + 63) / 64),
+      inode_links_(inode_cnt_) {
+  if (threads_ == 0)
+    threads_ = std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool DiskChecker::test_and_set(std::vector<std::atomic<u64>>& bitmap,
+                               u32 idx) {
+  u64 mask = u64(1) << (idx % 64);
+  return bitmap[idx / 64].fetch_or(mask, std::memory_order_relaxed) & mask;
+}
+
+bool DiskChecker::test(const std::vector<std::atomic<u64>>& bitmap, u32 idx) {
+  u64 mask = u64(1) << (idx % 64);
+  return bitmap[idx / 64].load(std::memory_order_relaxed) & mask;
+}
+
+/**
+ * @brief
+ *
+ * ڵǰ̰߳ӳٷļд̡̿λͼ
+ * ȻбĿ¼̱߳ȶԡ
+ * Ŀ¼ĺϷԺü˳д̿Ŀ¼ļм¼
+ * 𻵵Ŀ¼Ŀ¼׳쳣гϹӱ档
+ */
+u32 DiskChecker::check() {
+  disk_.flush_delayed();
+  disk_.load_free_map();
+
+  DiskInodeTravesalMixin mixin;
+  mixin.threads_ = threads_;
+  mixin.traverse_border_ = [this](i32 cur_idx, i32 father_idx) {
+    return visit_entry(cur_idx, father_idx);
+  };
+  mixin.directory_handler_ = [this](i32 cur_idx, i32) {
+    const Inode& inode = disk_.inodes_[cur_idx];
+    if (inode.d_size_ % sizeof(DirectoryEntry) != 0)
+      report("inode " + std::to_string(cur_idx) +
+             " is a directory of irregular size " +
+             std::to_string(inode.d_size_));
+    std::string errmsg = check_inode(cur_idx);
+    if (!errmsg.empty()) throw FileSystemException(errmsg);
+  };
+  mixin.file_handler_ = [this](i32 cur_idx, i32) {
+    std::string errmsg = check_inode(cur_idx);
+    if (!errmsg.empty())
+      report("inode " + std::to_string(cur_idx) + ": " + errmsg);
+  };
+  mixin.failure_handler_ = [this](Inode& inode, const std::string& errmsg) {
+    report("inode " + std::to_string(&inode - disk_.inodes_) + ": " + errmsg);
+  };
+  disk_.traverse_inode_tree(disk_.inodes_[Disk::IDX_ROOT_INODE], mixin);
+
+  // ڵ̿ҪôãҪôУ߶ǻ򶼲ǡ
+  const SuperBlock& sb = disk_.superblock_;
+  for (u32 idx = sb.p_off_data_; idx < sb.p_off_data_ + sb.p_size_data_;
+       ++idx) {
+    bool used = test(block_refs_, idx), free = disk_.free_map_.is_free(idx);
+    if (used && free)
+      report("block " + std::to_string(idx) + " is in use but marked free");
+    else if (!used && !free)
+      report("block " + std::to_string(idx) + " is leaked");
+  }
+
+  // Ŀ¼ûĿ¼ãһΡ
+  inode_links_[Disk::IDX_ROOT_INODE] += 1;
+  for (i32 idx = Disk::IDX_ROOT_INODE; idx < inode_cnt_; ++idx) {
+    const Inode& inode = disk_.inodes_[idx];
+    bool reached = test(inode_reached_, idx);
+    std::string name = "inode " + std::to_string(idx);
+    if (reached && !inode.ialloc_) {
+      report(name + " is referenced but not allocated");
+    } else if (!reached && inode.ialloc_) {
+      report(name + " is allocated but unreachable");
+    } else if (reached && i32(inode.d_nlink_) != inode_links_[idx]) {
+      report(name + " has nlink " + std::to_string(inode.d_nlink_) +
+             " but " + std::to_string(inode_links_[idx]) + " links");
+    }
+  }
+
+  // еĿinodeܺѷinode
+  for (u32 idx = 0; idx < sb.s_ninode_ && idx < 100; ++idx) {
+    i32 inode_idx = sb.s_inode_[idx];
+    if (inode_idx > i32(Disk::IDX_ROOT_INODE) && inode_idx < inode_cnt_ &&
+        disk_.inodes_[inode_idx].ialloc_)
+      report("free inode list holds allocated inode " +
+             std::to_string(inode_idx));
+  }
+
+  return problems_.size();
+}
+
+const std::vector<std::string>& DiskChecker::problems() const {
+  return problems_;
+}
+
+u32 DiskChecker::inodes_reached() const {
+  u32 ret = 0;
+  for (auto& word : inode_reached_) ret += __builtin_popcountll(word.load());
+  return ret;
+}
+
+u32 DiskChecker::blocks_referenced() const {
+  u32 ret = 0;
+  for (auto& word : block_refs_) ret += __builtin_popcountll(word.load());
+  return ret;
+}
+
+bool DiskChecker::visit_entry(i32 inode_idx, i32 father_idx) {
+  // Ŀ¼ֻǱ㡣
+  if (father_idx >= 0 && inode_idx == i32(Disk::IDX_ROOT_INODE)) {
+    report("inode " + std::to_string(father_idx) +
+           " has an entry to invalid inode " + std::to_string(inode_idx));
+    return true;
+  }
+  if (father_idx >= 0) inode_links_[inode_idx] += 1;
+  return test_and_set(inode_reached_, inode_idx);
+}
+
+std::string DiskChecker::check_inode(i32 inode_idx) {
+  // ߲Ķ߳̿ͬʱС
+  struct Marker : BlockVisitor {
+    DiskChecker& checker_;
+    i32 inode_idx_;
+    std::string errmsg_;
+
+    Marker(DiskChecker& checker, i32 inode_idx)
+        : checker_(checker), inode_idx_(inode_idx) {}
+
+    void direct_setup(i32, i32 blk_idx) {
+      checker_.mark_block(inode_idx_, blk_idx);
+    }
+    // ̿¼;ʧʱҲᱻΪй©
+    void indirect_setup(const char*, i32 blk_idx) {
+      checker_.mark_block(inode_idx_, blk_idx);
+    }
+    void failure(Inode&, i32, const std::string& msg) { errmsg_ = msg; }
+  } marker(*this, inode_idx);
+  disk_.traverse_blocks(disk_.inodes_[inode_idx], marker);
+  return marker.errmsg_;
+}
+
+void DiskChecker::mark_block(i32 inode_idx, i32 block_idx) {
+  const SuperBlock& sb = disk_.superblock_;
+  if (block_idx < i32(sb.p_off_data_) ||
+      block_idx >= i32(sb.p_off_data_ + sb.p_size_data_)) {
+    report("inode " + std::to_string(inode_idx) +
+           " refers to block " + std::to_string(block_idx) +
+           " outside the data zone");
+    return;
+  }
+  if (test_and_set(block_refs_, block_idx))
+    report("block " + std::to_string(block_idx) +
+           " is referenced more than once (again by inode " +
+           std::to_string(inode_idx) + ")");
+}
+
+void DiskChecker::report(const std::string& msg) {
+  std::lock_guard<std::mutex> lock(problems_lock_);
+  problems_.push_back(msg);
+}
@@ -0,0 +1,99 @@
+/**
+ * @file v6pp_readahead.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 18:16:52
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+
+#include "v6pp_readahead.hpp"
+
+using namespace v6pp;
+
+ReadAhead::ReadAhead(BlockCache& cache, u32 window)
+    : cache_(cache), window_(window), thread_(&ReadAhead::worker, this) {}
+
+ReadAhead::~ReadAhead() {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    stop_ = true;
+    requests_.clear();
+  }
+  cond_.notify_all();
+  thread_.join();
+}
+
+/**
+ * @brief
+ *
+ * η̿鼴Ϊ˳ʡ
+ * ԤĲĹʱǰƽһڡ
+ */
+void ReadAhead::observe(i32 block_idx) {
+  // Сȡηͬһ飬ıģʽ
+  if (block_idx == last_block_) return;
+  i32 stride = block_idx - last_block_;
+  last_block_ = block_idx;
+
+  if (stride != 1 && stride != -1) {
+    stride_ = 0;
+    return;
+  }
+  if (stride != stride_) {
+    stride_ = stride;
+    frontier_ = block_idx + stride;
+  }
+
+  // Ԥ߽绹жٿ顣
+  i32 ahead = (frontier_ - block_idx) * stride_;
+  if (ahead > window_ / 2) return;
+  if (ahead <= 0) frontier_ = block_idx + stride_;
+
+  i32 first = frontier_;
+  i32 last = block_idx + stride_ * window_;
+  if (stride_ < 0) std::swap(first, last);
+  first = std::max(first, 0);
+  last = std::min(last, i32(DiskProps::get_disk_blocks()) - 1);
+  frontier_ = block_idx + stride_ * (window_ + 1);
+  if (first > last) return;
+
+  issued_ += last - first + 1;
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    requests_.push_back({first, last - first + 1});
+  }
+  cond_.notify_one();
+}
+
+void ReadAhead::drain() {
+  std::unique_lock<std::mutex> lock(lock_);
+  requests_.clear();
+  cond_.wait(lock, [this]() { return !busy_; });
+}
+
+u64 ReadAhead::issued() const { return issued_; }
+
+void ReadAhead::worker() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (true) {
+    cond_.wait(lock, [this]() { return stop_ || !requests_.empty(); });
+    if (stop_) return;
+
+    auto req = requests_.front();
+    requests_.pop_front();
+    busy_ = true;
+    lock.unlock();
+
+    // Ԥʧ޹ؽҪȡʱٴα档
+    cache_.fill(req.first, req.second, reader_);
+
+    lock.lock();
+    busy_ = false;
+    cond_.notify_all();
+  }
+}
\ No newline at end of file
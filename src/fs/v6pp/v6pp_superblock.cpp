@@ -21,9 +21,7 @@ char* SuperBlock::data() { return (char*)(this); }
 const char* SuperBlock::data() const { return (const char*)(this); }
 
 bool SuperBlock::load(io::FileBase& file) {
-  file.seekg(SUPER_BLOCK_OFFSET, io::FileBase::FILE_SET);
-  file.read(data(), sizeof(SuperBlock));
-  if (!file.good()) {
+  if (!file.read_at(SUPER_BLOCK_OFFSET, data(), sizeof(SuperBlock))) {
     file.error();
     return false;
   }
@@ -31,15 +29,23 @@ bool SuperBlock::load(io::FileBase& file) {
 }
 
 bool SuperBlock::update(io::FileBase& file) {
-  file.seekp(SUPER_BLOCK_OFFSET, io::FileBase::FILE_SET);
-  file.write(data(), sizeof(SuperBlock));
-  if (!file.good()) {
+  if (!file.write_at(SUPER_BLOCK_OFFSET, data(), sizeof(SuperBlock))) {
     file.error();
     return false;
   }
   return true;
 }
 
+u32 SuperBlock::free_list_checksum() const {
+  // FNV-1as_nfree_
+  u32 ret = 2166136261u;
+  const byte* p = (const byte*)&s_nfree_;
+  for (size_t idx = 0; idx < sizeof(s_nfree_) + sizeof(s_free_); ++idx) {
+    ret = (ret ^ p[idx]) * 16777619u;
+  }
+  return ret ? ret : 1;
+}
+
 void SuperBlock::format() {
   SuperBlock copy;
   copy.s_ninode_ = 0;
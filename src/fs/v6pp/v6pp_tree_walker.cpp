@@ -0,0 +1,218 @@
+/**
+ * @file v6pp_tree_walker.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-18 00:12:37
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "exceptions.hpp"
+#include "v6pp_tree_walker.hpp"
+
+using namespace v6pp;
+
+InodeTreeWalker::InodeTreeWalker(Disk& disk,
+                                 const DiskInodeTravesalMixin& mixin)
+    : disk_(disk), mixin_(mixin), threads_(mixin.threads_) {
+  if (threads_ == 0)
+    threads_ = std::max(1u, std::thread::hardware_concurrency());
+  for (u32 idx = 0; idx < threads_; ++idx)
+    workers_.emplace_back(new Worker());
+}
+
+/**
+ * @brief
+ *
+ * ߳ʱֱڵǰ̱߳ӿ޸Ĵ̶
+ */
+bool InodeTreeWalker::walk(i32 root_idx) {
+  if (mixin_.traverse_border_(root_idx, -1)) return true;
+  if (threads_ > 1) disk_.flush_delayed();
+
+  spawn(0, root_idx, -1, nullptr);
+  if (threads_ == 1) {
+    run(0);
+  } else {
+    std::vector<std::thread> threads;
+    for (u32 idx = 0; idx < threads_; ++idx)
+      threads.emplace_back(&InodeTreeWalker::run, this, idx);
+    for (auto& th : threads) th.join();
+  }
+
+  if (error_) std::rethrow_exception(error_);
+  return !failed_;
+}
+
+void InodeTreeWalker::run(u32 self) {
+  while (true) {
+    Task* task = take(self);
+    if (!task) {
+      std::unique_lock<std::mutex> lock(idle_lock_);
+      idle_cond_.wait(lock,
+                      [&] { return queued_ > 0 || outstanding_ == 0; });
+      if (outstanding_ == 0) break;
+      continue;
+    }
+
+    execute(self, task);
+    if (--outstanding_ == 0) {
+      std::lock_guard<std::mutex> lock(idle_lock_);
+      idle_cond_.notify_all();
+    }
+  }
+}
+
+InodeTreeWalker::Task* InodeTreeWalker::take(u32 self) {
+  for (u32 step = 0; step < threads_; ++step) {
+    Worker& worker = *workers_[(self + step) % threads_];
+    std::lock_guard<std::mutex> lock(worker.lock_);
+    if (worker.tasks_.empty()) continue;
+
+    Task* ret;
+    if (step == 0) {
+      ret = worker.tasks_.back();
+      worker.tasks_.pop_back();
+    } else {
+      ret = worker.tasks_.front();
+      worker.tasks_.pop_front();
+    }
+    --queued_;
+    return ret;
+  }
+  return nullptr;
+}
+
+InodeTreeWalker::Task* InodeTreeWalker::spawn(u32 self, i32 inode_idx,
+                                              i32 father_idx, Task* parent) {
+  Worker& worker = *workers_[self];
+  Task* task = new Task{inode_idx, father_idx, parent, {1}};
+  worker.owned_.emplace_back(task);
+  if (parent) ++parent->pending_;
+  ++outstanding_;
+  {
+    std::lock_guard<std::mutex> lock(worker.lock_);
+    worker.tasks_.push_back(task);
+  }
+  {
+    std::lock_guard<std::mutex> lock(idle_lock_);
+    ++queued_;
+    idle_cond_.notify_one();
+  }
+  return task;
+}
+
+void InodeTreeWalker::execute(u32 self, Task* task) {
+  // Ϲ׳쳣ٴµĿ¼ֻѼꡣ
+  if (!aborted_) {
+    i32 cur_idx = task->inode_idx_;
+    try {
+      if (mixin_.order_ == DiskInodeTravesalMixin::PRE_ORDER)
+        mixin_.directory_handler_(cur_idx, task->father_idx_);
+
+      std::vector<i32> children = list_directory(cur_idx);
+      std::vector<i32> subdirs;
+      for (i32 child : children) {
+        if (mixin_.traverse_border_(child, cur_idx)) continue;
+        if (disk_.inodes_[child].file_type_ == FileType::DIR)
+          subdirs.push_back(child);
+        else
+          mixin_.file_handler_(child, cur_idx);
+      }
+      // ӣʹ߳ʱĿ¼˳ȱ
+      for (auto it = subdirs.rbegin(); it != subdirs.rend(); ++it)
+        spawn(self, *it, cur_idx, task);
+    } catch (FileSystemException& e) {
+      fail(cur_idx, e.what());
+    } catch (std::exception&) {
+      raise();
+    }
+  }
+  finish(task);
+}
+
+void InodeTreeWalker::finish(Task* task) {
+  while (task && --task->pending_ == 0) {
+    if (mixin_.order_ == DiskInodeTravesalMixin::POST_ORDER && !aborted_) {
+      try {
+        mixin_.directory_handler_(task->inode_idx_, task->father_idx_);
+      } catch (FileSystemException& e) {
+        fail(task->inode_idx_, e.what());
+      } catch (std::exception&) {
+        raise();
+      }
+    }
+    task = task->parent_;
+  }
+}
+
+std::vector<i32> InodeTreeWalker::list_directory(i32 inode_idx) {
+  Inode& inode = disk_.inodes_[inode_idx];
+  if (inode.file_type_ != FileType::DIR) {
+    auto ex = FileSystemException(
+        "InodeTreeWalker::list_directory: inode is not a directory.");
+    ex.set_kv("inode_idx", inode_idx);
+    throw ex;
+  }
+
+  // Ŀ¼룬ŶӶдԱ߳ͬʱС
+  struct Lister : public BlockVisitor {
+    Disk& disk_;
+    std::vector<char> content_;
+    Lister(Disk& disk, u32 size)
+        : disk_(disk),
+          content_((size + sizeof(Block) - 1) / sizeof(Block) *
+                   sizeof(Block)) {}
+    void direct_process(i32 fileoff, i32 blk_idx) {
+      if (!disk_.read_blocks(content_.data() + fileoff, blk_idx, 1))
+        throw FileSystemException("directory block reading failed");
+    }
+    void failure(Inode&, i32, const std::string& msg) {
+      throw FileSystemException(msg);
+    }
+  } lister(disk_, inode.d_size_);
+  disk_.traverse_blocks(inode, lister);
+
+  std::vector<i32> ret;
+  const DirectoryEntry* entries = (const DirectoryEntry*)lister.content_.data();
+  i32 inode_cnt = sizeof(disk_.inodes_) / sizeof(Inode);
+  for (u32 idx = 0; idx < inode.d_size_ / sizeof(DirectoryEntry); ++idx) {
+    i32 child = entries[idx].inode_id_;
+    // 0inodeʾĿ¼
+    if (child == 0) continue;
+    if (child < 0 || child >= inode_cnt) {
+      auto ex = FileSystemException(
+          "InodeTreeWalker::list_directory: invalid directory entry");
+      ex.set_kv("inode_idx", inode_idx);
+      ex.set_kv("child", child);
+      fail(inode_idx, ex.what());
+      continue;
+    }
+    ret.push_back(child);
+  }
+  return ret;
+}
+
+void InodeTreeWalker::fail(i32 inode_idx, const std::string& msg) {
+  std::lock_guard<std::mutex> lock(error_lock_);
+  failed_ = true;
+  if (error_) return;
+  try {
+    mixin_.failure_handler_(disk_.inodes_[inode_idx], msg);
+  } catch (...) {
+    error_ = std::current_exception();
+    aborted_ = true;
+  }
+}
+
+void InodeTreeWalker::raise() {
+  std::lock_guard<std::mutex> lock(error_lock_);
+  failed_ = true;
+  aborted_ = true;
+  if (!error_) error_ = std::current_exception();
+}
\ No newline at end of file
@@ -16,6 +16,8 @@
 
 #include "exceptions.hpp"
 #include "util_time.hpp"
+#include "v6pp_file_handle.hpp"
+#include "v6pp_fsck.hpp"
 #include "v6pp_vfs.hpp"
 
 using namespace v6pp;
@@ -58,12 +60,12 @@ FileSystem::FileSystem(const FileSystemConfig& config) : config_(config) {
       }
 
       // ʽ
-      disk_ = new Disk(config.disk_path_);
+      disk_ = new Disk(config.disk_path_, config.disk_config_);
       format();
       disk_->load();
     } else {
       // ߴȷֱӼء
-      disk_ = new Disk(config.disk_path_);
+      disk_ = new Disk(config.disk_path_, config.disk_config_);
       disk_->load();
     }
   } catch (FileSystemException& e) {
@@ -186,26 +188,19 @@ i32 FileSystem::rm(const ArgPack& args) {
         return -1;
       }
 
-      // ݹɾĿ¼ļ
-      std::function<void(Inode&, std::string)> remove_recurse =
-          [&](Inode& inode, std::string cwd) {
-            auto dir = disk_->read_inode_directory(inode);
-            while (cwd.back() == '/' || cwd.back() == '\\') cwd.pop_back();
-
-            for (i32 idx = 0; idx < dir->length_; ++idx) {
-              Inode& subnode = disk_->inodes_[dir->entries_[idx].inode_id_];
-              if (subnode.file_type_ == FileType::DIR) {
-                remove_recurse(subnode, cwd + '/' + dir->entries_[idx].name_);
-              }
-              disk_->free_inode_blocks(subnode);
-              disk_->free_inode(dir->entries_[idx].inode_id_);
-            }
-            // ֱдĿ¼Ըļ
-            // Ϊʲô_rmfileж:)
-            disk_->write_file((char*)dir->entries_, inode, 0);
-          };
-
-      remove_recurse(inode, args[0]);
+      // ɾĿ¼ļĿ¼_rmfileɾ
+      DiskInodeTravesalMixin mixin;
+      mixin.order_ = DiskInodeTravesalMixin::POST_ORDER;
+      mixin.file_handler_ = [&](i32 cur_idx, i32) {
+        // inodeŻᱻãͷŵinodeĿ¼档
+        dentries_.erase(cur_idx);
+        disk_->free_inode_blocks(disk_->inodes_[cur_idx]);
+        disk_->free_inode(cur_idx);
+      };
+      mixin.directory_handler_ = [&](i32 cur_idx, i32 father_idx) {
+        if (father_idx >= 0) mixin.file_handler_(cur_idx, father_idx);
+      };
+      disk_->traverse_inode_tree(inode, mixin);
       disk_->free_inode_blocks(inode);
       _rmfile(args[0], FileType::DIR);
     }  // if(inode.file_type_==DIR)
@@ -235,11 +230,7 @@ i32 FileSystem::cp(const ArgPack& args) {
       throw FileSystemException("source file is not a normal file.");
     Inode& dst_inode = _touch(args[1], FileType::NORMAL);
 
-    char* fbuf = new char[(src_inode.d_size_ + DiskProps::BLOCK_SIZE)];
-    disk_->read_file(fbuf, src_inode);
-    disk_->write_file(fbuf, dst_inode, src_inode.d_size_);
-    delete[] fbuf;
-    // Ƚûߵķʽʵļд룬ʵ֡
+    _copy(src_inode, dst_inode);
   } catch (FileSystemException& e) {
     config_.speaker_("cp: " + e.what());
     return -1;
@@ -261,10 +252,7 @@ i32 FileSystem::mv(const ArgPack& args) {
       throw FileSystemException("source file is not a normal file: " + args[0]);
     Inode& dst_inode = _touch(args[1], FileType::NORMAL);
 
-    char* fbuf = new char[(src_inode.d_size_ + DiskProps::BLOCK_SIZE)];
-    disk_->read_file(fbuf, src_inode);
-    disk_->write_file(fbuf, dst_inode, src_inode.d_size_);
-    delete[] fbuf;
+    _copy(src_inode, dst_inode);
 
     _rmfile(args[0], FileType::NORMAL);
   } catch (FileSystemException& e) {
@@ -354,28 +342,84 @@ i32 FileSystem::upload(const ArgPack& args) {
       return -1;
     }
 
+    // ӳٷʱļڴ棬̿дʱٷ䡣
+    if (fsize > 0 && u32(fsize) <= disk_->config_.delay_alloc_bytes_) {
+      std::vector<char> data(fsize);
+      flocal.seekg(0, std::ios::beg);
+      flocal.read(data.data(), fsize);
+      disk_->write_file(data.data(), inode, fsize);
+      return 0;
+    }
+
+    // ̿һϣļԵõ̿顣
+    std::vector<i32> reserved;
+    if (!disk_->alloc_blocks(Disk::blocks_for_size(fsize), reserved)) {
+      config_.speaker_("upload: not enough free blocks for " + args[0]);
+      return -1;
+    }
+
     i32 size_remaining = fsize;
     inode.d_size_ = size_remaining;
     inode.ilarg_ = !!(size_remaining > i32(6 * sizeof(Block)));
     inode.prot_owner_ = inode.prot_group_ = inode.prot_others_ = 7;
+    disk_->mark_inode_dirty(inode);
 
     flocal.seekg(0, std::ios::beg);
 
     // ̿飬дļ
-    DiskBlockTraversalMixin mixin;
-    mixin.block_allocator_ = [&](i32 old_blk_idx) {
-      return disk_->alloc_block();
-    };
-    mixin.direct_block_process_ = [&](i32 fileoff, i32 blk_idx) {
-      Block b;
-      flocal.read(b.data(), sizeof(b));
-      disk_->write_block(b, blk_idx);
-    };
-    mixin.indirect_block_teardown_ = [&](const char* pblk, i32 blk_idx) {
-      disk_->write_blocks(pblk, blk_idx, 1);
-    };
+    // ݿ鰴ڷŶӣÿһύһΡ
+    // ȡԶ뻺أֱӶдģʽת
+    struct Uploader : BlockVisitor {
+      Disk& disk_;
+      std::fstream& flocal_;
+      const std::vector<i32>& reserved_;
+      size_t next_reserved_ = 0;
+      io::AlignedBufferPool::Buffer window_;
+      i32 queued_ = 0;
+
+      Uploader(Disk& disk, std::fstream& flocal,
+               const std::vector<i32>& reserved)
+          : disk_(disk), flocal_(flocal), reserved_(reserved),
+            window_(disk.pool_) {}
+
+      i32 allocate(i32) {
+        return next_reserved_ < reserved_.size() ? reserved_[next_reserved_++]
+                                                 : -1;
+      }
+      void direct_process(i32, i32 blk_idx) {
+        if (queued_ == disk_.io_depth()) {
+          submit();
+          queued_ = 0;
+        }
+        char* pblk = window_.data() + (queued_++) * sizeof(Block);
+        memset(pblk, 0, sizeof(Block));
+        flocal_.read(pblk, sizeof(Block));
+        disk_.queue_write_blocks(pblk, blk_idx, 1);
+      }
+      void indirect_teardown(const char* pblk, i32 blk_idx) {
+        if (!disk_.write_blocks(pblk, blk_idx, 1)) {
+          // Ŷӵдôڣ쳣ͷǰȶ
+          disk_.discard_blocks();
+          auto ex = FileSystemException("index block writing failed");
+          ex.set_kv("reason", disk_.file_->error());
+          throw ex;
+        }
+      }
+      void failure(Inode&, i32, const std::string& msg) {
+        disk_.discard_blocks();
+        throw FileSystemException(msg);
+      }
+      void submit() {
+        if (!disk_.submit_blocks()) {
+          auto ex = FileSystemException("data block writing failed");
+          ex.set_kv("reason", disk_.file_->error());
+          throw ex;
+        }
+      }
+    } uploader(*disk_, flocal, reserved);
 
-    disk_->traverse_blocks_over_inode(inode, mixin);
+    disk_->traverse_blocks(inode, uploader);
+    uploader.submit();
   } catch (FileSystemException& e) {
     config_.speaker_("upload: " + e.what());
     return -1;
@@ -401,17 +445,11 @@ i32 FileSystem::download(const ArgPack& args) {
     flocal.clear();
     flocal.seekp(0, std::ios::beg);
 
-    DiskBlockTraversalMixin mixin;
-    mixin.direct_block_process_ = [&](i32, i32 blk_idx) {
-      Block b;
-      disk_->read_block(b, blk_idx);
-      i32 wrlen = std::min(sizeof(b), (size_t)inode.d_size_ - flocal.tellp());
-      flocal.write(b.data(), wrlen);
-    };
-    mixin.failure_handler_ = [&](Inode&, i32, const std::string& msg) {
-      throw FileSystemException(msg);
-    };
-    disk_->traverse_blocks_over_inode(inode, mixin);
+    // ڷ벢дȡԶ뻺ء
+    io::AlignedBufferPool::Buffer window(disk_->pool_);
+    FileHandle fin(*disk_, inode);
+    for (i32 len; (len = fin.read(window.data(), window.size())) > 0;)
+      flocal.write(window.data(), len);
   } catch (FileSystemException& e) {
     config_.speaker_("download: " + e.what());
     return -1;
@@ -433,32 +471,12 @@ i32 FileSystem::format(const ArgPack& args) {
       return -1;
     }
 
-    disk_->superblock_.format();
-    // ΪѾãԴ̴ʱѾɥʧ˶inodeʹ̿׷٣
-    // ֱӱͷһinode̿ˡ
-    for (i32 idx = Disk::IDX_ROOT_INODE;
-         idx < DiskProps::BLOCKS_INODE_ZONE * sizeof(Block) / sizeof(Inode);
-         ++idx)
-      disk_->free_inode(idx);
-    for (i32 idx = disk_->superblock_.p_off_data_;
-         idx < disk_->superblock_.p_off_data_ + disk_->superblock_.p_size_data_;
-         ++idx)
-      disk_->free_block(idx);
+    disk_->format();
+    dentries_.clear();
 
     inode_idx_stack_.clear();
     inode_idx_stack_.push_back(Disk::IDX_ROOT_INODE);
 
-    Inode& root = disk_->inodes_[Disk::IDX_ROOT_INODE];
-    root.prot_owner_ = root.prot_group_ = root.prot_others_ = 7;
-    root.d_nlink_ = 1;
-    root.file_type_ = FileType::DIR;
-    root.d_size_ = 0;
-    root.d_mtime_ = Time::stamp();
-    root.d_atime_ = Time::stamp();
-    root.is_gid_ = root.is_uid_ = 0;
-    root.d_gid_ = root.d_uid_ = 0;
-    root.ialloc_ = 1;
-
     mkdir({"dev"});
     _touch("/dev/tty1", FileType::CHAR_DEV);
 
@@ -470,6 +488,92 @@ i32 FileSystem::format(const ArgPack& args) {
   return 0;
 }
 
+/**
+ * @brief
+ *
+ * Ƭʱļָֻļ
+ */
+i32 FileSystem::defrag(const ArgPack& args) {
+  if (args.size() > 1) {
+    config_.speaker_("Usage: defrag [DISKPATH]");
+    return -1;
+  }
+
+  try {
+    std::vector<i32> targets;
+    if (args.size() == 1) {
+      targets.push_back(_pwalk(args[0], false).back());
+    } else {
+      for (i32 idx = Disk::IDX_ROOT_INODE;
+           idx < i32(sizeof(disk_->inodes_) / sizeof(Inode)); ++idx) {
+        if (disk_->inodes_[idx].ialloc_) targets.push_back(idx);
+      }
+    }
+
+    i32 fragmented = 0, relocated = 0, runs_before = 0, runs_after = 0;
+    for (i32 idx : targets) {
+      Inode& inode = disk_->inodes_[idx];
+      i32 runs = disk_->count_fragments(inode);
+      runs_before += runs;
+      if (runs > 1) {
+        ++fragmented;
+        if (disk_->defrag_inode(inode)) {
+          ++relocated;
+          runs = disk_->count_fragments(inode);
+        }
+      }
+      runs_after += runs;
+    }
+
+    config_.speaker_("defrag: " + std::to_string(targets.size()) + " files, " +
+                     std::to_string(fragmented) + " fragmented, " +
+                     std::to_string(relocated) + " relocated, runs " +
+                     std::to_string(runs_before) + " -> " +
+                     std::to_string(runs_after));
+  } catch (FileSystemException& e) {
+    config_.speaker_("defrag: " + e.what());
+    return -1;
+  }
+  return 0;
+}
+
+i32 FileSystem::df(const ArgPack& args) {
+  if (args.size() != 0) {
+    config_.speaker_("Usage: df");
+    return -1;
+  }
+
+  try {
+    u32 total[2] = {disk_->total_block_count(), disk_->total_inode_count()};
+    u32 free[2] = {disk_->free_block_count(), disk_->free_inode_count()};
+    const char* names[2] = {"Blocks", "Inodes"};
+
+    char logbuf[80];
+    sprintf(logbuf, "%8s%10s%10s%10s%6s", "", "Total", "Used", "Free", "Use%");
+    config_.speaker_(logbuf);
+    for (i32 idx = 0; idx < 2; ++idx) {
+      u32 used = total[idx] - free[idx];
+      sprintf(logbuf, "%8s%10u%10u%10u%5u%%", names[idx], total[idx], used,
+              free[idx], total[idx] ? u32(u64(used) * 100 / total[idx]) : 0);
+      config_.speaker_(logbuf);
+    }
+  } catch (FileSystemException& e) {
+    config_.speaker_("df: " + e.what());
+    return -1;
+  }
+  return 0;
+}
+
+void FileSystem::_copy(Inode& src, Inode& dst) {
+  disk_->reserve_file(dst, src.d_size_);
+
+  io::AlignedBufferPool::Buffer window(disk_->pool_);
+  FileHandle fin(*disk_, src), fout(*disk_, dst);
+  for (i32 len; (len = fin.read(window.data(), window.size())) > 0;)
+    fout.write(window.data(), len);
+  fout.close();
+}
+
 i32 FileSystem::testblock(const ArgPack& args) {
   if (args.size() != 1) {
     config_.speaker_("Usage: testblock BLOCKID");
@@ -535,6 +639,14 @@ i32 FileSystem::testdisk(const ArgPack& args) {
   }
 
   try {
+    DiskChecker checker(*disk_);
+    u32 problem_cnt = checker.check();
+    for (auto& msg : checker.problems()) config_.speaker_("testdisk: " + msg);
+    config_.speaker_("testdisk: " + std::to_string(checker.inodes_reached()) +
+                     " inodes, " + std::to_string(checker.blocks_referenced()) +
+                     " blocks in use, " + std::to_string(problem_cnt) +
+                     " problems found");
+    if (problem_cnt > 0) return -1;
   } catch (FileSystemException& e) {
     config_.speaker_("testdisk: " + e.what());
     return -1;
@@ -576,31 +688,41 @@ std::vector<i32> FileSystem::_pwalk(const std::string& path,
       // һתᱻԵ
       if (ret.size() > 1) ret.pop_back();
     } else {
-      auto curdir =
-          disk_->read_inode_directory(disk_->inodes_[ret.back()], true);
-      i32 found = 0;
-      for (i32 idx = 0; idx < curdir->length_; ++idx) {
-        if (seg == curdir->entries_[idx].name_) {
-          found = 1;
-          Inode& inode = disk_->inodes_[curdir->entries_[idx].inode_id_];
-          if (to_directory && inode.file_type_ != FileType::DIR) {
-            throw FileSystemException("FileSystem::_pwalk: not a directory: " +
-                                      seg);
-          } else {
-            ret.push_back(curdir->entries_[idx].inode_id_);
-          }
-        }  // if(seg==name_)
-      }    // for(idx)
-
-      if (!found)
+      i32 child = _lookup(ret.back(), seg);
+      if (child < 0)
         throw FileSystemException(
             "FileSystem::_pwalk: cannot find directory: " + seg);
+      if (to_directory && disk_->inodes_[child].file_type_ != FileType::DIR)
+        throw FileSystemException("FileSystem::_pwalk: not a directory: " +
+                                  seg);
+      ret.push_back(child);
     }  // else
   }    // for(seg:pathsegs)
 
   return ret;
 }
 
+/**
+ * @brief
+ *
+ * δƶһĿ¼ȫ뻺棬ҲƼΪ-1
+ * ʱһ£ȡһͨļûκƣҲ档
+ */
+i32 FileSystem::_lookup(i32 dir_idx, const std::string& name) {
+  if (disk_->inodes_[dir_idx].file_type_ != FileType::DIR) return -1;
+
+  auto& names = dentries_[dir_idx];
+  auto it = names.find(name);
+  if (it != names.end()) return it->second;
+
+  auto dir = disk_->read_inode_directory(disk_->inodes_[dir_idx], true);
+  for (i32 idx = 0; idx < dir->length_; ++idx) {
+    i32 child = dir->entries_[idx].inode_id_;
+    names[dir->entries_[idx].name_] = child;
+  }
+  return names.emplace(name, -1).first->second;
+}
+
 std::string FileSystem::_getcwd() {
   if (inode_idx_stack_.size() == 1) return "/";
   std::string path = "";
@@ -642,10 +764,10 @@ Inode& FileSystem::_touch(const std::string& path, FileType ftype) {
         "FileSystem::_touch: file or directory name exceeds length limit.");
   }
 
-  Inode& parent_inode =
-      disk_->inodes_[(last_delim == -1)
-                         ? (inode_idx_stack_.back())
-                         : (_pwalk(path.substr(0, last_delim), true).back())];
+  i32 parent_idx = (last_delim == -1)
+                       ? (inode_idx_stack_.back())
+                       : (_pwalk(path.substr(0, last_delim), true).back());
+  Inode& parent_inode = disk_->inodes_[parent_idx];
   std::string fname = path.substr(last_delim + 1);
   // dir_stride=1ΪпҪдһĿ¼
   auto parent_dir = disk_->read_inode_directory(parent_inode, false, 1);
@@ -664,6 +786,7 @@ Inode& FileSystem::_touch(const std::string& path, FileType ftype) {
   Inode& new_inode = disk_->inodes_[new_idx];
 
   new_inode.file_type_ = ftype;
+  disk_->mark_inode_dirty(new_idx);
   parent_dir->entries_[parent_dir->length_].inode_id_ = new_idx;
   memset((parent_dir->entries_[parent_dir->length_].name_), 0,
          sizeof(DirectoryEntry::name_));
@@ -674,6 +797,7 @@ Inode& FileSystem::_touch(const std::string& path, FileType ftype) {
   // дȥ
   disk_->write_file((char*)(parent_dir->entries_), parent_inode,
                     (parent_dir->length_) * sizeof(DirectoryEntry));
+  dentries_[parent_idx][fname] = new_idx;
 
   return new_inode;
 }
@@ -725,6 +849,12 @@ void FileSystem::_rmfile(const std::string& path, FileType ftype) {
   disk_->write_file((char*)fa_dir->entries_, inode_fa,
                     fa_dir->length_ * sizeof(DirectoryEntry));
 
+  // Ŀ¼еƲٴڣĿ¼Ļһ
+  for (auto& dentry : dentries_[*-- --idx_stk.end()]) {
+    if (dentry.second == idx_stk.back()) dentry.second = -1;
+  }
+  dentries_.erase(idx_stk.back());
+
   // ļɾͷŸļռõinodeԴ
   disk_->free_inode_blocks(inode_tar);
   disk_->free_inode(idx_stk.back());
@@ -0,0 +1,57 @@
+/**
+ * @file aligned_pool.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 15:17:44
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <new>
+
+#include "io_aligned_pool.hpp"
+
+using namespace io;
+
+AlignedBufferPool::AlignedBufferPool(size_t buffer_size, size_t alignment)
+    : buffer_size_(buffer_size), alignment_(alignment) {}
+
+AlignedBufferPool::~AlignedBufferPool() {
+  for (char* buffer : all_) {
+    ::operator delete[](buffer, std::align_val_t(alignment_));
+  }
+}
+
+char* AlignedBufferPool::acquire() {
+  std::lock_guard<std::mutex> lock(lock_);
+  if (!free_.empty()) {
+    char* ret = free_.back();
+    free_.pop_back();
+    return ret;
+  }
+
+  char* ret =
+      (char*)::operator new[](buffer_size_, std::align_val_t(alignment_));
+  all_.push_back(ret);
+  return ret;
+}
+
+void AlignedBufferPool::release(char* buffer) {
+  std::lock_guard<std::mutex> lock(lock_);
+  free_.push_back(buffer);
+}
+
+size_t AlignedBufferPool::buffer_size() const { return buffer_size_; }
+
+size_t AlignedBufferPool::alignment() const { return alignment_; }
+
+AlignedBufferPool::Buffer::Buffer(AlignedBufferPool& pool)
+    : pool_(pool), data_(pool.acquire()) {}
+
+AlignedBufferPool::Buffer::~Buffer() { pool_.release(data_); }
+
+char* AlignedBufferPool::Buffer::data() { return data_; }
+
+size_t AlignedBufferPool::Buffer::size() const { return pool_.buffer_size(); }
\ No newline at end of file
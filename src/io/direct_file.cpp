@@ -0,0 +1,113 @@
+/**
+ * @file direct_file.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 15:44:51
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#include "io_direct_file.hpp"
+
+using namespace io;
+
+// תĴСķǶֶδ
+static constexpr size_t BOUNCE_SIZE = 64u * 1024u;
+
+DirectFile::DirectFile(const std::string& filepath)
+    : PosixFile(filepath, true), bounce_pool_(BOUNCE_SIZE) {
+#if defined(STATX_DIOALIGN) && defined(AT_EMPTY_PATH)
+  struct statx stx;
+  if (::statx(fd_, "", AT_EMPTY_PATH, STATX_DIOALIGN, &stx) == 0 &&
+      (stx.stx_mask & STATX_DIOALIGN) && stx.stx_dio_offset_align > 0 &&
+      stx.stx_dio_mem_align > 0) {
+    offset_align_ = stx.stx_dio_offset_align;
+    memory_align_ = stx.stx_dio_mem_align;
+  }
+#endif
+}
+
+bool DirectFile::is_aligned(i64 offset, const char* addr, size_t size) const {
+  return offset % offset_align_ == 0 && size % offset_align_ == 0 &&
+         u64(addr) % memory_align_ == 0;
+}
+
+bool DirectFile::read_at(i64 offset, char* dest_addr, size_t rdsize) {
+  if (is_aligned(offset, dest_addr, rdsize))
+    return PosixFile::read_at(offset, dest_addr, rdsize);
+
+  AlignedBufferPool::Buffer bounce(bounce_pool_);
+  for (size_t done = 0; done < rdsize;) {
+    i64 pos = offset + done;
+    i64 base = pos - pos % offset_align_;
+    size_t head = pos - base;
+    size_t len = std::min(rdsize - done, bounce.size() - head);
+    size_t span = (head + len + offset_align_ - 1) / offset_align_ *
+                  offset_align_;
+
+    if (!PosixFile::read_at(base, bounce.data(), span)) return false;
+    memcpy(dest_addr + done, bounce.data() + head, len);
+    done += len;
+  }
+  return true;
+}
+
+bool DirectFile::write_at(i64 offset, const char* src_addr, size_t wrsize) {
+  if (is_aligned(offset, src_addr, wrsize))
+    return PosixFile::write_at(offset, src_addr, wrsize);
+
+  std::lock_guard<std::mutex> lock(rmw_lock_);
+  AlignedBufferPool::Buffer bounce(bounce_pool_);
+  for (size_t done = 0; done < wrsize;) {
+    i64 pos = offset + done;
+    i64 base = pos - pos % offset_align_;
+    size_t head = pos - base;
+    size_t len = std::min(wrsize - done, bounce.size() - head);
+    size_t span = (head + len + offset_align_ - 1) / offset_align_ *
+                  offset_align_;
+
+    // βĶ뵥λʱȶԭݡ
+    if (head != 0 || span != head + len) {
+      if (!PosixFile::read_at(base, bounce.data(), span)) return false;
+    }
+    memcpy(bounce.data() + head, src_addr + done, len);
+    if (!PosixFile::write_at(base, bounce.data(), span)) return false;
+    done += len;
+  }
+  return true;
+}
+
+bool DirectFile::readv_at(i64 offset, const IoSlice* slices, size_t cnt) {
+  // ֻÿһζʱ彻preadv
+  i64 pos = offset;
+  for (size_t idx = 0; idx < cnt; ++idx) {
+    if (!is_aligned(pos, slices[idx].addr_, slices[idx].size_))
+      return FileBase::readv_at(offset, slices, cnt);
+    pos += slices[idx].size_;
+  }
+  return PosixFile::readv_at(offset, slices, cnt);
+}
+
+bool DirectFile::writev_at(i64 offset, const IoSlice* slices, size_t cnt) {
+  i64 pos = offset;
+  for (size_t idx = 0; idx < cnt; ++idx) {
+    if (!is_aligned(pos, slices[idx].addr_, slices[idx].size_))
+      return FileBase::writev_at(offset, slices, cnt);
+    pos += slices[idx].size_;
+  }
+  return PosixFile::writev_at(offset, slices, cnt);
+}
+
+int DirectFile::native_handle() { return -1; }
+
+size_t DirectFile::alignment() { return offset_align_; }
\ No newline at end of file
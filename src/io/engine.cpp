@@ -0,0 +1,87 @@
+/**
+ * @file engine.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 13:16:09
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "exceptions.hpp"
+#include "io_engine.hpp"
+#include "io_uring_engine.hpp"
+
+using namespace io;
+
+IoEngine::IoEngine(FileBase& file) : file_(file) {}
+
+IoEngine::~IoEngine() {}
+
+void IoEngine::queue_read(i64 offset, char* dest_addr, size_t rdsize) {
+  IoSlice slice = {dest_addr, rdsize};
+  queue(offset, &slice, 1, false);
+}
+
+void IoEngine::queue_write(i64 offset, const char* src_addr, size_t wrsize) {
+  IoSlice slice = {(char*)src_addr, wrsize};
+  queue(offset, &slice, 1, true);
+}
+
+void IoEngine::queue_readv(i64 offset, const IoSlice* slices, size_t cnt) {
+  queue(offset, slices, cnt, false);
+}
+
+void IoEngine::queue_writev(i64 offset, const IoSlice* slices, size_t cnt) {
+  queue(offset, slices, cnt, true);
+}
+
+void IoEngine::queue(i64 offset, const IoSlice* slices, size_t cnt,
+                     bool write) {
+  Request req = {offset, slices_.size(), cnt, 0, write};
+  for (size_t idx = 0; idx < cnt; ++idx) {
+    slices_.push_back(slices[idx]);
+    req.size_ += slices[idx].size_;
+  }
+  requests_.push_back(req);
+}
+
+size_t IoEngine::queued() const { return requests_.size(); }
+
+void IoEngine::discard() {
+  requests_.clear();
+  slices_.clear();
+}
+
+bool IoEngine::submit_each(size_t first) {
+  bool ok = true;
+  for (size_t idx = first; idx < requests_.size(); ++idx) {
+    const Request& req = requests_[idx];
+    const IoSlice* slices = slices_.data() + req.slice_begin_;
+    if (req.write_)
+      ok &= file_.writev_at(req.offset_, slices, req.slice_cnt_);
+    else
+      ok &= file_.readv_at(req.offset_, slices, req.slice_cnt_);
+  }
+  discard();
+  return ok;
+}
+
+IoEngine* IoEngine::create(FileBase& file, u32 depth) {
+  int fd = file.native_handle();
+  if (depth > 0 && fd >= 0) {
+    try {
+      return new UringIoEngine(file, fd, depth);
+    } catch (FileSystemException&) {
+      // io_uringã˻Ϊͬ档
+    }
+  }
+  return new SyncIoEngine(file);
+}
+
+SyncIoEngine::SyncIoEngine(FileBase& file) : IoEngine(file) {}
+
+bool SyncIoEngine::submit() { return submit_each(); }
+
+const char* SyncIoEngine::name() const { return "sync"; }
\ No newline at end of file
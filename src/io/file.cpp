@@ -14,6 +14,56 @@
 using namespace io;
 
 FileBase::FileBase(const std::string& filepath)
-    : file_path_(filepath), is_good_(1), error_() {}
+    : file_path_(filepath), error_() {}
 
-FileBase::~FileBase() {}
\ No newline at end of file
+FileBase::~FileBase() {}
+
+void FileBase::set_error(const std::string& msg) {
+  std::lock_guard<std::mutex> lock(error_lock_);
+  is_good_ = 0;
+  error_ = msg;
+}
+
+std::string FileBase::take_error() {
+  std::lock_guard<std::mutex> lock(error_lock_);
+  std::string ret = error_;
+  is_good_ = 1;
+  error_ = "";
+  return ret;
+}
+
+bool FileBase::read_at(i64 offset, char* dest_addr, size_t rdsize) {
+  std::lock_guard<std::mutex> lock(cursor_lock_);
+  seekg(offset, FILE_SET);
+  read(dest_addr, rdsize);
+  return good();
+}
+
+bool FileBase::write_at(i64 offset, const char* src_addr, size_t wrsize) {
+  std::lock_guard<std::mutex> lock(cursor_lock_);
+  seekp(offset, FILE_SET);
+  write(src_addr, wrsize);
+  return good();
+}
+
+bool FileBase::readv_at(i64 offset, const IoSlice* slices, size_t cnt) {
+  for (size_t idx = 0; idx < cnt; ++idx) {
+    if (!read_at(offset, slices[idx].addr_, slices[idx].size_)) return false;
+    offset += slices[idx].size_;
+  }
+  return true;
+}
+
+bool FileBase::writev_at(i64 offset, const IoSlice* slices, size_t cnt) {
+  for (size_t idx = 0; idx < cnt; ++idx) {
+    if (!write_at(offset, slices[idx].addr_, slices[idx].size_)) return false;
+    offset += slices[idx].size_;
+  }
+  return true;
+}
+
+bool FileBase::flush() { return true; }
+
+int FileBase::native_handle() { return -1; }
+
+size_t FileBase::alignment() { return 1; }
\ No newline at end of file
@@ -26,9 +26,8 @@ FstreamFile::~FstreamFile() { stream_.close(); }
 FileBase& FstreamFile::read(char* dest_addr, size_t rdsize) {
   stream_.read(dest_addr, rdsize);
   if (!stream_.good()) {
-    is_good_ = 0;
-    error_ = "FstreamFile::read(" + std::to_string(u64(dest_addr)) + ", " +
-             std::to_string(rdsize) + ") failed";
+    set_error("FstreamFile::read(" + std::to_string(u64(dest_addr)) + ", " +
+              std::to_string(rdsize) + ") failed");
   }
   return *this;
 }
@@ -36,9 +35,8 @@ FileBase& FstreamFile::read(char* dest_addr, size_t rdsize) {
 FileBase& FstreamFile::write(const char* src_addr, size_t wrsize) {
   stream_.write(src_addr, wrsize);
   if (!stream_.good()) {
-    is_good_ = 0;
-    error_ = "FstreamFile::write(" + std::to_string(u64(src_addr)) + ", " +
-             std::to_string(wrsize) + ") failed";
+    set_error("FstreamFile::write(" + std::to_string(u64(src_addr)) + ", " +
+              std::to_string(wrsize) + ") failed");
   }
   return *this;
 }
@@ -80,12 +78,19 @@ i32 FstreamFile::tellp() { return stream_.tellp(); }
 bool FstreamFile::good() { return !!is_good_; }
 
 std::string FstreamFile::error() {
-  std::string ret = error_;
+  std::string ret = take_error();
 
   // ԭļ״̬
-  is_good_ = 1;
-  error_ = "";
   stream_.clear();
 
   return ret;
+}
+
+bool FstreamFile::flush() {
+  stream_.flush();
+  if (!stream_.good()) {
+    set_error("FstreamFile::flush() failed");
+    return false;
+  }
+  return true;
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+/**
+ * @file mmap_file.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 10:20:08
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "exceptions.hpp"
+#include "io_mmap_file.hpp"
+
+using namespace io;
+
+MmapFile::MmapFile(const std::string& filepath) : FileBase(filepath) {
+#ifdef _WIN32
+  throw FileSystemException("MmapFile: not supported on this platform");
+#else
+  fd_ = ::open(filepath.c_str(), O_RDWR);
+  if (fd_ < 0) {
+    throw FileSystemException("cannot open " + filepath);
+  }
+
+  struct stat st;
+  if (::fstat(fd_, &st) != 0) {
+    ::close(fd_);
+    throw FileSystemException("cannot stat " + filepath);
+  }
+  size_ = st.st_size;
+
+  // ļ޷ӳ䣬ϲ㰴ߴ
+  if (size_ > 0) {
+    void* addr =
+        ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) {
+      ::close(fd_);
+      throw FileSystemException("cannot mmap " + filepath);
+    }
+    data_ = (byte*)addr;
+  }
+#endif
+}
+
+MmapFile::~MmapFile() {
+#ifndef _WIN32
+  if (data_) ::munmap(data_, size_);
+  if (fd_ >= 0) ::close(fd_);
+#endif
+}
+
+FileBase& MmapFile::read(char* dest_addr, size_t rdsize) {
+  if (gpos_ < 0 || !read_at(gpos_, dest_addr, rdsize)) {
+    gpos_ = -1;
+  } else {
+    gpos_ += rdsize;
+  }
+  return *this;
+}
+
+FileBase& MmapFile::write(const char* src_addr, size_t wrsize) {
+  if (ppos_ < 0 || !write_at(ppos_, src_addr, wrsize)) {
+    ppos_ = -1;
+  } else {
+    ppos_ += wrsize;
+  }
+  return *this;
+}
+
+i64 MmapFile::seek(i64 pos, i32 offset, u32 seekdir) {
+  switch (seekdir) {
+    case FILE_SET:
+      return offset;
+    case FILE_CUR:
+      return (pos < 0) ? pos : pos + offset;
+    case FILE_END:
+      return size_ + offset;
+  }
+  return pos;
+}
+
+FileBase& MmapFile::seekg(i32 offset, u32 seekdir) {
+  gpos_ = seek(gpos_, offset, seekdir);
+  return *this;
+}
+
+FileBase& MmapFile::seekp(i32 offset, u32 seekdir) {
+  ppos_ = seek(ppos_, offset, seekdir);
+  return *this;
+}
+
+i32 MmapFile::tellg() { return gpos_; }
+
+i32 MmapFile::tellp() { return ppos_; }
+
+bool MmapFile::good() { return !!is_good_; }
+
+std::string MmapFile::error() {
+  std::string ret = take_error();
+
+  if (gpos_ < 0) gpos_ = 0;
+  if (ppos_ < 0) ppos_ = 0;
+
+  return ret;
+}
+
+bool MmapFile::read_at(i64 offset, char* dest_addr, size_t rdsize) {
+  if (offset < 0 || offset + i64(rdsize) > size_) {
+    set_error("MmapFile::read_at(" + std::to_string(offset) + ", " +
+              std::to_string(rdsize) + ") failed");
+    return false;
+  }
+  memcpy(dest_addr, data_ + offset, rdsize);
+  return true;
+}
+
+bool MmapFile::write_at(i64 offset, const char* src_addr, size_t wrsize) {
+  if (offset < 0 || offset + i64(wrsize) > size_) {
+    set_error("MmapFile::write_at(" + std::to_string(offset) + ", " +
+              std::to_string(wrsize) + ") failed");
+    return false;
+  }
+  memcpy(data_ + offset, src_addr, wrsize);
+  return true;
+}
\ No newline at end of file
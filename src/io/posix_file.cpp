@@ -0,0 +1,202 @@
+/**
+ * @file posix_file.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 11:10:31
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "exceptions.hpp"
+#include "io_posix_file.hpp"
+
+using namespace io;
+
+PosixFile::PosixFile(const std::string& filepath)
+    : PosixFile(filepath, false) {}
+
+PosixFile::PosixFile(const std::string& filepath, bool direct)
+    : FileBase(filepath) {
+#ifdef _WIN32
+  throw FileSystemException("PosixFile: not supported on this platform");
+#else
+  int flags = O_RDWR;
+  if (direct) {
+#ifdef O_DIRECT
+    flags |= O_DIRECT;
+#else
+    throw FileSystemException("PosixFile: O_DIRECT is not supported");
+#endif
+  }
+
+  fd_ = ::open(filepath.c_str(), flags);
+  if (fd_ < 0) {
+    auto ex = FileSystemException("cannot open " + filepath);
+    ex.set_kv("errno", errno);
+    throw ex;
+  }
+#endif
+}
+
+PosixFile::~PosixFile() {
+#ifndef _WIN32
+  if (fd_ >= 0) ::close(fd_);
+#endif
+}
+
+FileBase& PosixFile::read(char* dest_addr, size_t rdsize) {
+  if (gpos_ < 0 || !read_at(gpos_, dest_addr, rdsize)) {
+    gpos_ = -1;
+  } else {
+    gpos_ += rdsize;
+  }
+  return *this;
+}
+
+FileBase& PosixFile::write(const char* src_addr, size_t wrsize) {
+  if (ppos_ < 0 || !write_at(ppos_, src_addr, wrsize)) {
+    ppos_ = -1;
+  } else {
+    ppos_ += wrsize;
+  }
+  return *this;
+}
+
+i64 PosixFile::seek(i64 pos, i32 offset, u32 seekdir) {
+#ifndef _WIN32
+  switch (seekdir) {
+    case FILE_SET:
+      return offset;
+    case FILE_CUR:
+      return (pos < 0) ? pos : pos + offset;
+    case FILE_END: {
+      struct stat st;
+      if (::fstat(fd_, &st) != 0) return -1;
+      return st.st_size + offset;
+    }
+  }
+#endif
+  return pos;
+}
+
+FileBase& PosixFile::seekg(i32 offset, u32 seekdir) {
+  gpos_ = seek(gpos_, offset, seekdir);
+  return *this;
+}
+
+FileBase& PosixFile::seekp(i32 offset, u32 seekdir) {
+  ppos_ = seek(ppos_, offset, seekdir);
+  return *this;
+}
+
+i32 PosixFile::tellg() { return gpos_; }
+
+i32 PosixFile::tellp() { return ppos_; }
+
+bool PosixFile::good() { return !!is_good_; }
+
+std::string PosixFile::error() {
+  std::string ret = take_error();
+
+  if (gpos_ < 0) gpos_ = 0;
+  if (ppos_ < 0) ppos_ = 0;
+
+  return ret;
+}
+
+bool PosixFile::read_at(i64 offset, char* dest_addr, size_t rdsize) {
+#ifndef _WIN32
+  size_t done = 0;
+  while (done < rdsize) {
+    ssize_t ret = ::pread(fd_, dest_addr + done, rdsize - done, offset + done);
+    if (ret < 0 && errno == EINTR) continue;
+    // ļĩβҲΪʧܡ
+    if (ret <= 0) break;
+    done += ret;
+  }
+  if (done == rdsize) return true;
+#endif
+  set_error("PosixFile::read_at(" + std::to_string(offset) + ", " +
+            std::to_string(rdsize) + ") failed");
+  return false;
+}
+
+bool PosixFile::write_at(i64 offset, const char* src_addr, size_t wrsize) {
+#ifndef _WIN32
+  size_t done = 0;
+  while (done < wrsize) {
+    ssize_t ret = ::pwrite(fd_, src_addr + done, wrsize - done, offset + done);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) break;
+    done += ret;
+  }
+  if (done == wrsize) return true;
+#endif
+  set_error("PosixFile::write_at(" + std::to_string(offset) + ", " +
+            std::to_string(wrsize) + ") failed");
+  return false;
+}
+
+bool PosixFile::readv_at(i64 offset, const IoSlice* slices, size_t cnt) {
+  return transfer_v(offset, slices, cnt, false);
+}
+
+bool PosixFile::writev_at(i64 offset, const IoSlice* slices, size_t cnt) {
+  return transfer_v(offset, slices, cnt, true);
+}
+
+bool PosixFile::transfer_v(i64 offset, const IoSlice* slices, size_t cnt,
+                           bool write) {
+#ifndef _WIN32
+  std::vector<iovec> iovs(cnt);
+  for (size_t idx = 0; idx < cnt; ++idx) {
+    iovs[idx].iov_base = slices[idx].addr_;
+    iovs[idx].iov_len = slices[idx].size_;
+  }
+
+  i64 pos = offset;
+  size_t first = 0;
+  while (first < cnt) {
+    int iovcnt = std::min<size_t>(cnt - first, IOV_MAX);
+    ssize_t ret = write ? ::pwritev(fd_, iovs.data() + first, iovcnt, pos)
+                        : ::preadv(fd_, iovs.data() + first, iovcnt, pos);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) break;
+    pos += ret;
+
+    // ѾɵĶΣֻһֵĶΡ
+    while (ret > 0) {
+      if (size_t(ret) >= iovs[first].iov_len) {
+        ret -= iovs[first].iov_len;
+        ++first;
+      } else {
+        iovs[first].iov_base = (char*)iovs[first].iov_base + ret;
+        iovs[first].iov_len -= ret;
+        ret = 0;
+      }
+    }
+    while (first < cnt && iovs[first].iov_len == 0) ++first;
+  }
+  if (first == cnt) return true;
+#endif
+  set_error(std::string("PosixFile::") +
+            (write ? "writev_at(" : "readv_at(") + std::to_string(offset) +
+            ", " + std::to_string(cnt) + ") failed");
+  return false;
+}
+
+int PosixFile::native_handle() { return fd_; }
\ No newline at end of file
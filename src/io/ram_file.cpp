@@ -0,0 +1,157 @@
+/**
+ * @file ram_file.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 16:38:02
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "exceptions.hpp"
+#include "io_fstream_file.hpp"
+#include "io_ram_file.hpp"
+
+using namespace io;
+
+// εļ¼Ԫ̿Сһ¡
+static constexpr i64 DIRTY_UNIT = 512;
+
+RamFile::RamFile(const std::string& filepath) : FileBase(filepath) {
+  backing_ = new FstreamFile(filepath);
+
+  backing_->seekg(0, FILE_END);
+  i64 size = backing_->tellg();
+  if (size < 0) {
+    delete backing_;
+    throw FileSystemException("cannot open " + filepath);
+  }
+
+  data_.resize(size);
+  if (size > 0 && !backing_->read_at(0, (char*)data_.data(), size)) {
+    delete backing_;
+    throw FileSystemException("cannot read " + filepath);
+  }
+  dirty_.assign((size + DIRTY_UNIT - 1) / DIRTY_UNIT, false);
+}
+
+RamFile::~RamFile() {
+  // ʱдأʧҲ޴ӱ档
+  flush();
+  delete backing_;
+}
+
+FileBase& RamFile::read(char* dest_addr, size_t rdsize) {
+  if (gpos_ < 0 || !read_at(gpos_, dest_addr, rdsize)) {
+    gpos_ = -1;
+  } else {
+    gpos_ += rdsize;
+  }
+  return *this;
+}
+
+FileBase& RamFile::write(const char* src_addr, size_t wrsize) {
+  if (ppos_ < 0 || !write_at(ppos_, src_addr, wrsize)) {
+    ppos_ = -1;
+  } else {
+    ppos_ += wrsize;
+  }
+  return *this;
+}
+
+i64 RamFile::seek(i64 pos, i32 offset, u32 seekdir) {
+  switch (seekdir) {
+    case FILE_SET:
+      return offset;
+    case FILE_CUR:
+      return (pos < 0) ? pos : pos + offset;
+    case FILE_END:
+      return i64(data_.size()) + offset;
+  }
+  return pos;
+}
+
+FileBase& RamFile::seekg(i32 offset, u32 seekdir) {
+  gpos_ = seek(gpos_, offset, seekdir);
+  return *this;
+}
+
+FileBase& RamFile::seekp(i32 offset, u32 seekdir) {
+  ppos_ = seek(ppos_, offset, seekdir);
+  return *this;
+}
+
+i32 RamFile::tellg() { return gpos_; }
+
+i32 RamFile::tellp() { return ppos_; }
+
+bool RamFile::good() { return !!is_good_; }
+
+std::string RamFile::error() {
+  std::string ret = take_error();
+
+  if (gpos_ < 0) gpos_ = 0;
+  if (ppos_ < 0) ppos_ = 0;
+
+  return ret;
+}
+
+bool RamFile::read_at(i64 offset, char* dest_addr, size_t rdsize) {
+  if (offset < 0 || offset + i64(rdsize) > i64(data_.size())) {
+    set_error("RamFile::read_at(" + std::to_string(offset) + ", " +
+              std::to_string(rdsize) + ") failed");
+    return false;
+  }
+  memcpy(dest_addr, data_.data() + offset, rdsize);
+  return true;
+}
+
+bool RamFile::write_at(i64 offset, const char* src_addr, size_t wrsize) {
+  if (offset < 0 || offset + i64(wrsize) > i64(data_.size())) {
+    set_error("RamFile::write_at(" + std::to_string(offset) + ", " +
+              std::to_string(wrsize) + ") failed");
+    return false;
+  }
+  memcpy(data_.data() + offset, src_addr, wrsize);
+
+  if (wrsize > 0) {
+    std::lock_guard<std::mutex> lock(dirty_lock_);
+    i64 last = (offset + wrsize - 1) / DIRTY_UNIT;
+    for (i64 unit = offset / DIRTY_UNIT; unit <= last; ++unit)
+      dirty_[unit] = true;
+  }
+  return true;
+}
+
+/**
+ * @brief
+ *
+ * ѱддشļڵ൥ԪϲΪһд롣
+ */
+bool RamFile::flush() {
+  std::lock_guard<std::mutex> lock(dirty_lock_);
+  i64 units = dirty_.size();
+  for (i64 head = 0, tail; head < units; head = tail) {
+    if (!dirty_[head]) {
+      tail = head + 1;
+      continue;
+    }
+    for (tail = head; tail < units && dirty_[tail]; ++tail) {
+      dirty_[tail] = false;
+    }
+
+    i64 offset = head * DIRTY_UNIT;
+    i64 size = std::min(tail * DIRTY_UNIT, i64(data_.size())) - offset;
+    if (!backing_->write_at(offset, (char*)data_.data() + offset, size)) {
+      // дʧܵαΪ࣬´ԡ
+      for (i64 unit = head; unit < tail; ++unit) dirty_[unit] = true;
+      set_error("RamFile::flush: " + backing_->error());
+      return false;
+    }
+  }
+  return backing_->flush();
+}
\ No newline at end of file
@@ -0,0 +1,237 @@
+/**
+ * @file uring_engine.cpp
+ * @author CrackLewis (ghxx040406@163.com)
+ * @brief
+ * @version 0.1.0
+ * @date 2026-10-17 13:42:55
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define IO_URING_SUPPORTED 1
+#include <linux/io_uring.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+// linux/fs.hBLOCK_SIZEDiskProps::BLOCK_SIZEͻ
+#undef BLOCK_SIZE
+#endif
+
+#include "exceptions.hpp"
+#include "io_uring_engine.hpp"
+
+using namespace io;
+
+#ifdef IO_URING_SUPPORTED
+
+UringIoEngine::UringIoEngine(FileBase& file, int fd, u32 depth)
+    : IoEngine(file), fd_(fd) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  ring_fd_ = ::syscall(__NR_io_uring_setup, depth, &params);
+  if (ring_fd_ < 0) {
+    auto ex = FileSystemException("UringIoEngine: io_uring_setup failed");
+    ex.set_kv("errno", errno);
+    throw ex;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(u32);
+  cq_ring_size_ =
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  // ںύɶйһӳ
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+
+  sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    release();
+    throw FileSystemException("UringIoEngine: cannot map submission queue");
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      release();
+      throw FileSystemException("UringIoEngine: cannot map completion queue");
+    }
+  }
+
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    release();
+    throw FileSystemException("UringIoEngine: cannot map sqe array");
+  }
+
+  char* sq = (char*)sq_ring_;
+  sq_head_ = (u32*)(sq + params.sq_off.head);
+  sq_tail_ = (u32*)(sq + params.sq_off.tail);
+  sq_mask_ = (u32*)(sq + params.sq_off.ring_mask);
+  sq_array_ = (u32*)(sq + params.sq_off.array);
+  sq_entries_ = params.sq_entries;
+
+  char* cq = (char*)cq_ring_;
+  cq_head_ = (u32*)(cq + params.cq_off.head);
+  cq_tail_ = (u32*)(cq + params.cq_off.tail);
+  cq_mask_ = (u32*)(cq + params.cq_off.ring_mask);
+  cqes_ = cq + params.cq_off.cqes;
+}
+
+UringIoEngine::~UringIoEngine() { release(); }
+
+void UringIoEngine::release() {
+  if (sqes_) ::munmap(sqes_, sqes_size_);
+  if (cq_ring_ && cq_ring_ != sq_ring_) ::munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_) ::munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ >= 0) ::close(ring_fd_);
+  delete[](iovec*) iovecs_;
+
+  sqes_ = cq_ring_ = sq_ring_ = nullptr;
+  iovecs_ = nullptr;
+  iovecs_cap_ = 0;
+  ring_fd_ = -1;
+}
+
+bool UringIoEngine::submit() {
+  if (is_broken_) return submit_each();
+
+  bool ok = true;
+  io_uring_sqe* sqes = (io_uring_sqe*)sqes_;
+  io_uring_cqe* cqes = (io_uring_cqe*)cqes_;
+
+  // ոɶеCQEոĸ
+  auto reap = [&]() -> u32 {
+    u32 head = *cq_head_;
+    u32 ctail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    u32 cnt = ctail - head;
+    for (; head != ctail; ++head) {
+      const io_uring_cqe& cqe = cqes[head & *cq_mask_];
+      const Request& req = requests_[cqe.user_data];
+      // ̶дԶļֻᷢԽ紦Ϊʧܡ
+      if (cqe.res != i32(req.size_)) ok = false;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    return cnt;
+  };
+
+  for (size_t next = 0; next < requests_.size();) {
+    u32 batch = std::min<size_t>(requests_.size() - next, sq_entries_);
+
+    // ׼һiovec
+    size_t iov_cnt = 0;
+    for (u32 idx = 0; idx < batch; ++idx) {
+      iov_cnt += requests_[next + idx].slice_cnt_;
+    }
+    if (iov_cnt > iovecs_cap_) {
+      delete[](iovec*) iovecs_;
+      iovecs_ = new iovec[iov_cnt];
+      iovecs_cap_ = iov_cnt;
+    }
+    iovec* iovs = (iovec*)iovecs_;
+    for (size_t idx = 0; idx < iov_cnt; ++idx) {
+      const IoSlice& slice = slices_[requests_[next].slice_begin_ + idx];
+      iovs[idx].iov_base = slice.addr_;
+      iovs[idx].iov_len = slice.size_;
+    }
+
+    // дһSQEΨһߣβֱָӶ
+    u32 tail = *sq_tail_;
+    for (u32 idx = 0, iov_off = 0; idx < batch; ++idx) {
+      const Request& req = requests_[next + idx];
+      u32 slot = (tail + idx) & *sq_mask_;
+      io_uring_sqe& sqe = sqes[slot];
+
+      memset(&sqe, 0, sizeof(sqe));
+      sqe.opcode = req.write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe.fd = fd_;
+      sqe.addr = u64(iovs + iov_off);
+      sqe.len = req.slice_cnt_;
+      iov_off += req.slice_cnt_;
+      sqe.off = req.offset_;
+      sqe.user_data = next + idx;
+      sq_array_[slot] = slot;
+    }
+    __atomic_store_n(sq_tail_, tail + batch, __ATOMIC_RELEASE);
+
+    // ύȴɡύʱں˲ȴѭɡ
+    // ɶлѹ(EBUSY)ʱոһֻȴ;ύ
+    u32 submitted = 0, completed = 0;
+    bool backlog = false;
+    while (completed < batch) {
+      bool wait_only = backlog && submitted > completed;
+      u32 to_submit = wait_only ? 0 : batch - submitted;
+      u32 to_wait = wait_only ? 1 : batch - completed;
+      backlog = false;
+      int ret = ::syscall(__NR_io_uring_enter, ring_fd_, to_submit, to_wait,
+                          IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (ret < 0) {
+        if (errno == EAGAIN || errno == EBUSY) {
+          backlog = true;
+        } else if (errno != EINTR) {
+          // ״̬Ѳţ֮ύͬ·
+          is_broken_ = true;
+          break;
+        }
+      } else {
+        submitted += ret;
+      }
+      completed += reap();
+    }
+
+    if (is_broken_) {
+      // ύԿܷʻȫɲܷء
+      // ʹio_uring_enterһֱʧܣںҲCQEдɶС
+      while (completed < submitted) {
+        int ret = ::syscall(__NR_io_uring_enter, ring_fd_, 0,
+                            submitted - completed, IORING_ENTER_GETEVENTS,
+                            nullptr, 0);
+        u32 cnt = reap();
+        if (ret < 0 && cnt == 0) ::sched_yield();
+        completed += cnt;
+      }
+      // ںδȡߵSQEִͬС
+      __atomic_store_n(sq_tail_, tail + submitted, __ATOMIC_RELEASE);
+      bool rest_ok = submit_each(next + submitted);
+      return ok && rest_ok;
+    }
+    next += batch;
+  }
+
+  discard();
+  return ok;
+}
+
+#else
+
+UringIoEngine::UringIoEngine(FileBase& file, int fd, u32 depth)
+    : IoEngine(file), fd_(fd) {
+  throw FileSystemException("UringIoEngine: not supported on this platform");
+}
+
+UringIoEngine::~UringIoEngine() {}
+
+void UringIoEngine::release() {}
+
+bool UringIoEngine::submit() { return submit_each(); }
+
+#endif
+
+const char* UringIoEngine::name() const { return "io_uring"; }
\ No newline at end of file